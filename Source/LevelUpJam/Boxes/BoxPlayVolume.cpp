@@ -0,0 +1,52 @@
+#include "BoxPlayVolume.h"
+
+#include "BoxPoolSubsystem.h"
+#include "PooledBox.h"
+#include "LevelUpJam.h"
+#include "Components/BoxComponent.h"
+
+ABoxPlayVolume::ABoxPlayVolume()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Volume = CreateDefaultSubobject<UBoxComponent>(TEXT("Volume"));
+	RootComponent = Volume;
+	Volume->SetBoxExtent(FVector(1000.0f));
+	Volume->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	Volume->SetCollisionResponseToAllChannels(ECR_Ignore);
+	Volume->SetCollisionResponseToChannel(ECC_PhysicsBody, ECR_Overlap);
+	Volume->SetCollisionResponseToChannel(LevelUpJamCollision::PhysicsBox, ECR_Overlap);
+}
+
+void ABoxPlayVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Volume->OnComponentEndOverlap.AddDynamic(this, &ABoxPlayVolume::OnVolumeEndOverlap);
+}
+
+void ABoxPlayVolume::OnVolumeEndOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor,
+										UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+{
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::OverlapEvents);
+
+	APooledBox* Box = Cast<APooledBox>(OtherActor);
+	if (!Box || Box->IsInPool())
+	{
+		return;
+	}
+
+	// Volumes may overlap each other, only recycle once the box is outside all of them
+	TArray<AActor*> OtherVolumes;
+	Box->GetOverlappingActors(OtherVolumes, ABoxPlayVolume::StaticClass());
+	OtherVolumes.Remove(this);
+	if (!OtherVolumes.IsEmpty())
+	{
+		return;
+	}
+
+	if (UBoxPoolSubsystem* Pool = GetWorld()->GetSubsystem<UBoxPoolSubsystem>())
+	{
+		Pool->ReleaseBox(Box);
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "BoxPlayVolume.generated.h"
+
+class UBoxComponent;
+
+/**
+ * Area in which pooled boxes are in play. A box that leaves every play volume goes back to the
+ * pool instead of rolling around off screen.
+ */
+UCLASS()
+class LEVELUPJAM_API ABoxPlayVolume : public AActor
+{
+	GENERATED_BODY()
+	
+public:
+	ABoxPlayVolume();
+
+protected:
+	virtual void BeginPlay() override;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "BoxPool")
+	TObjectPtr<UBoxComponent> Volume;
+
+	UFUNCTION()
+	void OnVolumeEndOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor,
+							UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+};
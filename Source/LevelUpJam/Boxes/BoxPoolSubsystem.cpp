@@ -0,0 +1,169 @@
+#include "BoxPoolSubsystem.h"
+
+#include "PhysicsBudgetSubsystem.h"
+#include "PooledBox.h"
+#include "LevelUpJam.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Boxes Live"), STAT_PooledBoxesLive, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Boxes Free"), STAT_PooledBoxesFree, STATGROUP_LevelUpJam);
+
+void UBoxPoolSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Recycle anything that fell out of the level, before the engine's KillZ destroys it
+	const float RecycleZ = GetWorld()->GetWorldSettings()->KillZ + KillZMargin;
+	for (int32 Index = LiveBoxes.Num() - 1; Index >= 0; --Index)
+	{
+		APooledBox* Box = LiveBoxes[Index];
+		if (!IsValid(Box))
+		{
+			LiveBoxes.RemoveAtSwap(Index, EAllowShrinking::No);
+			continue;
+		}
+
+		if (Box->GetActorLocation().Z < RecycleZ)
+		{
+			ReleaseBox(Box);
+		}
+	}
+
+	Stats.Live = LiveBoxes.Num();
+	SET_DWORD_STAT(STAT_PooledBoxesLive, Stats.Live);
+	SET_DWORD_STAT(STAT_PooledBoxesFree, Stats.Free);
+	CSV_CUSTOM_STAT(LevelUpJam, PooledBoxesLive, Stats.Live, ECsvCustomStatOp::Set);
+}
+
+TStatId UBoxPoolSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UBoxPoolSubsystem, STATGROUP_Tickables);
+}
+
+void UBoxPoolSubsystem::Deinitialize()
+{
+	LiveBoxes.Reset();
+	FreeBoxes.Reset();
+
+	Super::Deinitialize();
+}
+
+APooledBox* UBoxPoolSubsystem::SpawnPooledBox(UClass* BoxClass)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	const double StartTime = FPlatformTime::Seconds();
+	APooledBox* Box = GetWorld()->SpawnActor<APooledBox>(BoxClass, ParkingLocation, FRotator::ZeroRotator, SpawnParams);
+	Stats.SpawnMs += static_cast<float>((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	if (Box)
+	{
+		++Stats.Spawned;
+	}
+	return Box;
+}
+
+APooledBox* UBoxPoolSubsystem::AcquireBox(TSubclassOf<APooledBox> BoxClass, const FTransform& Transform, UStaticMesh* Mesh, FVector Velocity)
+{
+	UClass* Class = BoxClass ? BoxClass.Get() : APooledBox::StaticClass();
+
+	if (LiveBoxes.Num() >= MaxLiveBoxes)
+	{
+		++Stats.Refused;
+		return nullptr;
+	}
+
+	APooledBox* Box = nullptr;
+	TArray<TObjectPtr<APooledBox>>* Free = FreeBoxes.Find(Class);
+	while (Free && !Free->IsEmpty() && !Box)
+	{
+		Box = Free->Pop(EAllowShrinking::No);
+		--Stats.Free;
+		Box = IsValid(Box) ? Box : nullptr;
+	}
+
+	if (Box)
+	{
+		++Stats.Reused;
+	}
+	else
+	{
+		Box = SpawnPooledBox(Class);
+		if (!Box)
+		{
+			return nullptr;
+		}
+	}
+
+	if (Mesh)
+	{
+		Box->GetMesh()->SetStaticMesh(Mesh);
+	}
+
+	Box->ActivateFromPool(Transform, Velocity);
+	LiveBoxes.Add(Box);
+
+	if (UPhysicsBudgetSubsystem* PhysicsBudget = GetWorld()->GetSubsystem<UPhysicsBudgetSubsystem>())
+	{
+		PhysicsBudget->RegisterBody(Box->GetMesh());
+	}
+
+	Stats.Live = LiveBoxes.Num();
+	Stats.PeakLive = FMath::Max(Stats.PeakLive, Stats.Live);
+	return Box;
+}
+
+void UBoxPoolSubsystem::ReleaseBox(APooledBox* Box)
+{
+	if (!IsValid(Box) || Box->IsInPool())
+	{
+		return;
+	}
+
+	LiveBoxes.RemoveSwap(Box, EAllowShrinking::No);
+
+	if (UPhysicsBudgetSubsystem* PhysicsBudget = GetWorld()->GetSubsystem<UPhysicsBudgetSubsystem>())
+	{
+		PhysicsBudget->UnregisterBody(Box->GetMesh());
+	}
+	Box->ReturnToPool(ParkingLocation);
+
+	FreeBoxes.FindOrAdd(Box->GetClass()).Add(Box);
+	++Stats.Free;
+	Stats.Live = LiveBoxes.Num();
+}
+
+void UBoxPoolSubsystem::Prewarm(TSubclassOf<APooledBox> BoxClass, int32 Count)
+{
+	UClass* Class = BoxClass ? BoxClass.Get() : APooledBox::StaticClass();
+	TArray<TObjectPtr<APooledBox>>& Free = FreeBoxes.FindOrAdd(Class);
+
+	for (int32 Index = Free.Num(); Index < Count; ++Index)
+	{
+		if (APooledBox* Box = SpawnPooledBox(Class))
+		{
+			Box->ReturnToPool(ParkingLocation);
+			Free.Add(Box);
+			++Stats.Free;
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GBoxPoolStatsCommand(
+	TEXT("LevelUpJam.BoxPool.Stats"),
+	TEXT("Log box pool occupancy and spawn cost."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const UBoxPoolSubsystem* Pool = World ? World->GetSubsystem<UBoxPoolSubsystem>() : nullptr;
+		if (!Pool)
+		{
+			return;
+		}
+
+		const FBoxPoolStats Stats = Pool->GetStats();
+		UE_LOG(LogLevelUpJam, Display, TEXT("Box pool: %d live (peak %d), %d free, %d spawned in %.2f ms, %d reused, %d refused."),
+			Stats.Live, Stats.PeakLive, Stats.Free, Stats.Spawned, Stats.SpawnMs, Stats.Reused, Stats.Refused);
+	}));
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BoxPoolSubsystem.generated.h"
+
+class APooledBox;
+class UStaticMesh;
+
+USTRUCT(BlueprintType)
+struct FBoxPoolStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "BoxPool")
+	int32 Live = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "BoxPool")
+	int32 Free = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "BoxPool")
+	int32 PeakLive = 0;
+
+	/** Boxes created with SpawnActor, including prewarming. */
+	UPROPERTY(BlueprintReadOnly, Category = "BoxPool")
+	int32 Spawned = 0;
+
+	/** Acquires served from the free list. */
+	UPROPERTY(BlueprintReadOnly, Category = "BoxPool")
+	int32 Reused = 0;
+
+	/** Acquires refused because the live cap was reached. */
+	UPROPERTY(BlueprintReadOnly, Category = "BoxPool")
+	int32 Refused = 0;
+
+	/** Total time spent in SpawnActor for pooled boxes. */
+	UPROPERTY(BlueprintReadOnly, Category = "BoxPool")
+	float SpawnMs = 0.0f;
+};
+
+/**
+ * Pre-allocates physics boxes and recycles them, so spawners and conveyors never pay for
+ * SpawnActor/Destroy during play. Boxes come back when they leave a play volume or fall below
+ * the kill height.
+ */
+UCLASS(Config = Game)
+class LEVELUPJAM_API UBoxPoolSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual void Deinitialize() override;
+
+	/** Takes a box from the pool (spawning one if the pool is empty). Returns null when the live cap is reached. */
+	UFUNCTION(BlueprintCallable, Category = "BoxPool")
+	APooledBox* AcquireBox(TSubclassOf<APooledBox> BoxClass, const FTransform& Transform, UStaticMesh* Mesh = nullptr, FVector Velocity = FVector::ZeroVector);
+
+	UFUNCTION(BlueprintCallable, Category = "BoxPool")
+	void ReleaseBox(APooledBox* Box);
+
+	/** Spawns boxes up front so the first acquires do not hitch. */
+	UFUNCTION(BlueprintCallable, Category = "BoxPool")
+	void Prewarm(TSubclassOf<APooledBox> BoxClass, int32 Count);
+
+	UFUNCTION(BlueprintPure, Category = "BoxPool")
+	FBoxPoolStats GetStats() const { return Stats; }
+
+	UFUNCTION(BlueprintPure, Category = "BoxPool")
+	int32 GetNumLiveBoxes() const { return LiveBoxes.Num(); }
+
+	const TArray<TObjectPtr<APooledBox>>& GetLiveBoxes() const { return LiveBoxes; }
+
+protected:
+	/** Maximum boxes in play at once across all pools. */
+	UPROPERTY(Config)
+	int32 MaxLiveBoxes = 500;
+
+	/** Boxes are recycled this far below the world's KillZ, before the engine destroys them. */
+	UPROPERTY(Config)
+	float KillZMargin = 100.0f;
+
+	/** Where pooled boxes wait while unused. */
+	UPROPERTY(Config)
+	FVector ParkingLocation = FVector(0.0f, 0.0f, -100000.0f);
+
+private:
+	APooledBox* SpawnPooledBox(UClass* BoxClass);
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<APooledBox>> LiveBoxes;
+
+	// Free boxes, one list per box class
+	TMap<TObjectPtr<UClass>, TArray<TObjectPtr<APooledBox>>> FreeBoxes;
+
+	FBoxPoolStats Stats;
+};
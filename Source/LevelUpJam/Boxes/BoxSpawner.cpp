@@ -0,0 +1,67 @@
+#include "BoxSpawner.h"
+
+#include "BoxPoolSubsystem.h"
+#include "PooledBox.h"
+#include "Components/ArrowComponent.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+
+ABoxSpawner::ABoxSpawner()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	SpawnPoint = CreateDefaultSubobject<UArrowComponent>(TEXT("SpawnPoint"));
+	RootComponent = SpawnPoint;
+}
+
+void ABoxSpawner::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UBoxPoolSubsystem* Pool = GetWorld()->GetSubsystem<UBoxPoolSubsystem>())
+	{
+		Pool->Prewarm(BoxClass, PrewarmCount);
+	}
+
+	if (SpawnInterval > 0.0f)
+	{
+		GetWorldTimerManager().SetTimer(SpawnTimer, FTimerDelegate::CreateWeakLambda(this, [this]()
+		{
+			SpawnBox();
+		}), SpawnInterval, true);
+	}
+}
+
+void ABoxSpawner::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(SpawnTimer);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+APooledBox* ABoxSpawner::SpawnBox()
+{
+	SpawnedBoxes.RemoveAllSwap([](const TWeakObjectPtr<APooledBox>& Box)
+	{
+		return !Box.IsValid() || Box->IsInPool();
+	}, EAllowShrinking::No);
+
+	if (MaxLiveBoxes > 0 && SpawnedBoxes.Num() >= MaxLiveBoxes)
+	{
+		return nullptr;
+	}
+
+	UBoxPoolSubsystem* Pool = GetWorld()->GetSubsystem<UBoxPoolSubsystem>();
+	if (!Pool)
+	{
+		return nullptr;
+	}
+
+	const FTransform Transform = SpawnPoint->GetComponentTransform();
+	APooledBox* Box = Pool->AcquireBox(BoxClass, Transform, BoxMesh, Transform.GetUnitAxis(EAxis::X) * SpawnSpeed);
+	if (Box)
+	{
+		SpawnedBoxes.Add(Box);
+	}
+	return Box;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "BoxSpawner.generated.h"
+
+class APooledBox;
+class UArrowComponent;
+class UStaticMesh;
+
+/**
+ * Emits physics boxes on a timer, taking them from UBoxPoolSubsystem rather than spawning them.
+ * Native replacement for the BP_BoxSpawner / dispenser machine blueprints.
+ */
+UCLASS()
+class LEVELUPJAM_API ABoxSpawner : public AActor
+{
+	GENERATED_BODY()
+	
+public:
+	ABoxSpawner();
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BoxSpawner")
+	TSubclassOf<APooledBox> BoxClass;
+
+	/** Overrides the mesh of the box class, leave empty to keep it. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BoxSpawner")
+	TObjectPtr<UStaticMesh> BoxMesh;
+
+	/** Seconds between two boxes, 0 to only spawn through SpawnBox. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BoxSpawner")
+	float SpawnInterval = 1.0f;
+
+	/** Speed given to new boxes along the spawn arrow. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BoxSpawner")
+	float SpawnSpeed = 0.0f;
+
+	/** Maximum boxes from this spawner in play at once, 0 for no limit besides the pool's. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BoxSpawner")
+	int32 MaxLiveBoxes = 20;
+
+	/** Boxes created in the pool at BeginPlay. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BoxSpawner")
+	int32 PrewarmCount = 10;
+
+	UFUNCTION(BlueprintCallable, Category = "BoxSpawner")
+	APooledBox* SpawnBox();
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "BoxSpawner")
+	TObjectPtr<UArrowComponent> SpawnPoint;
+
+	// Boxes handed out by this spawner, pruned when they go back to the pool
+	TArray<TWeakObjectPtr<APooledBox>> SpawnedBoxes;
+
+	FTimerHandle SpawnTimer;
+};
@@ -0,0 +1,307 @@
+#include "PhysicsBudgetSubsystem.h"
+
+#include "LevelUpJam.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+
+DECLARE_CYCLE_STAT(TEXT("Physics Budget Update"), STAT_PhysicsBudgetUpdate, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Physics Bodies Active"), STAT_PhysicsBodiesActive, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Physics Bodies Managed"), STAT_PhysicsBodiesManaged, STATGROUP_LevelUpJam);
+
+void UPhysicsBudgetSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	for (ULevel* Level : InWorld.GetLevels())
+	{
+		RegisterLevelBodies(Level);
+	}
+
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UPhysicsBudgetSubsystem::OnLevelAdded);
+}
+
+void UPhysicsBudgetSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+
+	Bodies.Reset();
+	BodyIndices.Reset();
+	WakeSources.Reset();
+
+	Super::Deinitialize();
+}
+
+void UPhysicsBudgetSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate >= UpdateInterval)
+	{
+		UpdateBudget(TimeSinceUpdate);
+		TimeSinceUpdate = 0.0f;
+	}
+}
+
+TStatId UPhysicsBudgetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPhysicsBudgetSubsystem, STATGROUP_Tickables);
+}
+
+void UPhysicsBudgetSubsystem::RegisterBody(UPrimitiveComponent* Component)
+{
+	if (!Component || BodyIndices.Contains(Component))
+	{
+		return;
+	}
+
+	FManagedBody& Body = Bodies.AddDefaulted_GetRef();
+	Body.Component = Component;
+	Body.State = Component->IsSimulatingPhysics() ? EPhysicsBudgetState::Active : EPhysicsBudgetState::Frozen;
+	BodyIndices.Add(Component, Bodies.Num() - 1);
+}
+
+void UPhysicsBudgetSubsystem::UnregisterBody(UPrimitiveComponent* Component)
+{
+	int32 Index = INDEX_NONE;
+	if (!BodyIndices.RemoveAndCopyValue(Component, Index))
+	{
+		return;
+	}
+
+	Bodies.RemoveAtSwap(Index, EAllowShrinking::No);
+	if (Bodies.IsValidIndex(Index))
+	{
+		BodyIndices.Add(Bodies[Index].Component, Index);
+	}
+}
+
+void UPhysicsBudgetSubsystem::RegisterWakeSource(AActor* Source, float Radius)
+{
+	if (!Source)
+	{
+		return;
+	}
+
+	const float WakeRadius = Radius < 0.0f ? DefaultWakeRadius : Radius;
+	WakeSources.Add({ Source, FMath::Square(WakeRadius) });
+}
+
+bool UPhysicsBudgetSubsystem::WakeBody(UPrimitiveComponent* Component)
+{
+	if (!Component)
+	{
+		return false;
+	}
+
+	if (const int32* Index = BodyIndices.Find(Component))
+	{
+		SetState(Bodies[*Index], EPhysicsBudgetState::Active);
+	}
+	return Component->IsSimulatingPhysics();
+}
+
+void UPhysicsBudgetSubsystem::RegisterLevelBodies(ULevel* Level)
+{
+	if (!Level)
+	{
+		return;
+	}
+
+	// Only root bodies are managed: toggling simulation on an attached component would detach it
+	for (AActor* Actor : Level->Actors)
+	{
+		if (!IsValid(Actor) || Actor->IsA<APawn>())
+		{
+			continue;
+		}
+
+		UPrimitiveComponent* Root = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+		if (Root && Root->Mobility == EComponentMobility::Movable && Root->IsSimulatingPhysics())
+		{
+			RegisterBody(Root);
+		}
+	}
+}
+
+void UPhysicsBudgetSubsystem::OnLevelAdded(ULevel* Level, UWorld* InWorld)
+{
+	if (InWorld == GetWorld())
+	{
+		RegisterLevelBodies(Level);
+	}
+}
+
+void UPhysicsBudgetSubsystem::UpdateBudget(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PhysicsBudgetUpdate);
+
+	SourceLocations.Reset();
+	SourceRadiiSquared.Reset();
+	for (int32 Index = WakeSources.Num() - 1; Index >= 0; --Index)
+	{
+		if (const AActor* Source = WakeSources[Index].Actor.Get())
+		{
+			SourceLocations.Add(Source->GetActorLocation());
+			SourceRadiiSquared.Add(WakeSources[Index].RadiusSquared);
+		}
+		else
+		{
+			WakeSources.RemoveAtSwap(Index, EAllowShrinking::No);
+		}
+	}
+
+	const float FreezeDistanceSquared = FMath::Square(FreezeDistance);
+	AwakeByDistance.Reset();
+	int32 NumInWakeRange = 0;
+
+	// Drop destroyed bodies first so the indices below stay stable
+	for (int32 Index = Bodies.Num() - 1; Index >= 0; --Index)
+	{
+		if (!Bodies[Index].Component.IsValid())
+		{
+			BodyIndices.Remove(Bodies[Index].Component);
+			Bodies.RemoveAtSwap(Index, EAllowShrinking::No);
+			if (Bodies.IsValidIndex(Index))
+			{
+				BodyIndices.Add(Bodies[Index].Component, Index);
+			}
+		}
+	}
+
+	for (int32 Index = 0; Index < Bodies.Num(); ++Index)
+	{
+		FManagedBody& Body = Bodies[Index];
+		UPrimitiveComponent* Component = Body.Component.Get();
+
+		const FVector Location = Component->GetComponentLocation();
+		float NearestDistanceSquared = TNumericLimits<float>::Max();
+		bool bInWakeRange = false;
+		for (int32 SourceIndex = 0; SourceIndex < SourceLocations.Num(); ++SourceIndex)
+		{
+			const float DistanceSquared = FVector::DistSquared(Location, SourceLocations[SourceIndex]);
+			NearestDistanceSquared = FMath::Min(NearestDistanceSquared, DistanceSquared);
+			bInWakeRange |= DistanceSquared <= SourceRadiiSquared[SourceIndex];
+		}
+
+		switch (Body.State)
+		{
+		case EPhysicsBudgetState::Frozen:
+			if (bInWakeRange)
+			{
+				SetState(Body, EPhysicsBudgetState::Active);
+			}
+			break;
+
+		case EPhysicsBudgetState::Asleep:
+			// Contacts can wake a sleeping body without us, count it as active again
+			if (bInWakeRange || Component->RigidBodyIsAwake())
+			{
+				SetState(Body, EPhysicsBudgetState::Active);
+			}
+			else if (NearestDistanceSquared > FreezeDistanceSquared)
+			{
+				SetState(Body, EPhysicsBudgetState::Frozen);
+			}
+			break;
+
+		case EPhysicsBudgetState::Active:
+			if (!bInWakeRange)
+			{
+				const bool bSettled = IsSettled(Component);
+				Body.SettledFor = bSettled ? Body.SettledFor + DeltaTime : 0.0f;
+				if (Body.SettledFor >= SettleTime)
+				{
+					SetState(Body, EPhysicsBudgetState::Asleep);
+				}
+			}
+			break;
+		}
+
+		// Bodies a source keeps awake would only be woken again next pass, they are not part of the budget
+		if (Body.State == EPhysicsBudgetState::Active)
+		{
+			if (bInWakeRange)
+			{
+				++NumInWakeRange;
+			}
+			else
+			{
+				AwakeByDistance.Emplace(NearestDistanceSquared, Index);
+			}
+		}
+	}
+
+	// Over budget: the bodies farthest from anything that could interact with them go to sleep.
+	// Bodies still moving are skipped, sleeping them would freeze them mid-air; they sleep once
+	// they settle.
+	const int32 MaxOutOfRange = FMath::Max(MaxActiveBodies - NumInWakeRange, 0);
+	int32 NumOutOfRange = AwakeByDistance.Num();
+	if (NumOutOfRange > MaxOutOfRange)
+	{
+		AwakeByDistance.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B)
+		{
+			return A.Key < B.Key;
+		});
+
+		for (int32 Index = AwakeByDistance.Num() - 1; Index >= 0 && NumOutOfRange > MaxOutOfRange; --Index)
+		{
+			FManagedBody& Body = Bodies[AwakeByDistance[Index].Value];
+			if (IsSettled(Body.Component.Get()))
+			{
+				SetState(Body, EPhysicsBudgetState::Asleep);
+				--NumOutOfRange;
+			}
+		}
+	}
+
+	NumActive = NumInWakeRange + NumOutOfRange;
+
+	SET_DWORD_STAT(STAT_PhysicsBodiesActive, NumActive);
+	SET_DWORD_STAT(STAT_PhysicsBodiesManaged, Bodies.Num());
+	CSV_CUSTOM_STAT(LevelUpJam, PhysicsBodiesActive, NumActive, ECsvCustomStatOp::Set);
+}
+
+bool UPhysicsBudgetSubsystem::IsSettled(const UPrimitiveComponent* Component) const
+{
+	return !Component->RigidBodyIsAwake()
+		|| (Component->GetPhysicsLinearVelocity().SizeSquared() < FMath::Square(SettledSpeed)
+			&& Component->GetPhysicsAngularVelocityInDegrees().SizeSquared() < FMath::Square(SettledAngularSpeed));
+}
+
+void UPhysicsBudgetSubsystem::SetState(FManagedBody& Body, EPhysicsBudgetState NewState)
+{
+	UPrimitiveComponent* Component = Body.Component.Get();
+	if (!Component)
+	{
+		return;
+	}
+
+	switch (NewState)
+	{
+	case EPhysicsBudgetState::Active:
+		if (!Component->IsSimulatingPhysics())
+		{
+			Component->SetSimulatePhysics(true);
+		}
+		Component->WakeRigidBody();
+		Body.SettledFor = 0.0f;
+		break;
+
+	case EPhysicsBudgetState::Asleep:
+		if (!Component->IsSimulatingPhysics())
+		{
+			Component->SetSimulatePhysics(true);
+		}
+		Component->PutRigidBodyToSleep();
+		break;
+
+	case EPhysicsBudgetState::Frozen:
+		Component->SetSimulatePhysics(false);
+		break;
+	}
+
+	Body.State = NewState;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PhysicsBudgetSubsystem.generated.h"
+
+class UPrimitiveComponent;
+
+UENUM(BlueprintType)
+enum class EPhysicsBudgetState : uint8
+{
+	// Simulating and allowed to stay awake
+	Active,
+	// Simulating but put to sleep, woken by the solver on contact
+	Asleep,
+	// Not simulating at all: the body is kinematic until something comes close
+	Frozen
+};
+
+/**
+ * Keeps the number of awake rigid bodies under a budget. Simulated boxes that are far from every
+ * wake source, or have settled, are put to sleep and then frozen as kinematic bodies. Launch pads,
+ * drones and players register as wake sources and bring bodies within their radius back to life.
+ */
+UCLASS(Config = Game)
+class LEVELUPJAM_API UPhysicsBudgetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterBody(UPrimitiveComponent* Component);
+	void UnregisterBody(UPrimitiveComponent* Component);
+
+	// Radius below 0 uses the configured default
+	void RegisterWakeSource(AActor* Source, float Radius = -1.0f);
+
+	// Makes a managed body simulate again right away, e.g. when a launch pad touches it.
+	// Returns true if the component simulates physics afterwards.
+	bool WakeBody(UPrimitiveComponent* Component);
+
+	UFUNCTION(BlueprintPure, Category = "PhysicsBudget")
+	int32 GetNumActiveBodies() const { return NumActive; }
+
+	UFUNCTION(BlueprintPure, Category = "PhysicsBudget")
+	int32 GetNumManagedBodies() const { return Bodies.Num(); }
+
+protected:
+	/** Maximum bodies left awake at once. The bodies farthest from any wake source sleep first; bodies inside a wake radius and bodies still moving stay awake and may exceed it. */
+	UPROPERTY(Config)
+	int32 MaxActiveBodies = 150;
+
+	/** Wake radius used by sources that do not give one. */
+	UPROPERTY(Config)
+	float DefaultWakeRadius = 800.0f;
+
+	/** Sleeping bodies further than this from every wake source stop simulating. */
+	UPROPERTY(Config)
+	float FreezeDistance = 3000.0f;
+
+	/** Speed under which a body counts as settled. */
+	UPROPERTY(Config)
+	float SettledSpeed = 5.0f;
+
+	/** Rotation speed in degrees per second under which a body counts as settled. */
+	UPROPERTY(Config)
+	float SettledAngularSpeed = 10.0f;
+
+	/** Time a body must stay settled before it is put to sleep. */
+	UPROPERTY(Config)
+	float SettleTime = 1.0f;
+
+	/** Seconds between two budget passes. */
+	UPROPERTY(Config)
+	float UpdateInterval = 0.2f;
+
+private:
+	struct FManagedBody
+	{
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		EPhysicsBudgetState State = EPhysicsBudgetState::Active;
+		float SettledFor = 0.0f;
+	};
+
+	struct FWakeSource
+	{
+		TWeakObjectPtr<AActor> Actor;
+		float RadiusSquared = 0.0f;
+	};
+
+	void RegisterLevelBodies(ULevel* Level);
+	void OnLevelAdded(ULevel* Level, UWorld* InWorld);
+	void UpdateBudget(float DeltaTime);
+	bool IsSettled(const UPrimitiveComponent* Component) const;
+	void SetState(FManagedBody& Body, EPhysicsBudgetState NewState);
+
+	TArray<FManagedBody> Bodies;
+	TMap<TWeakObjectPtr<UPrimitiveComponent>, int32> BodyIndices;
+	TArray<FWakeSource> WakeSources;
+
+	// Scratch buffers for the budget pass
+	TArray<FVector> SourceLocations;
+	TArray<float> SourceRadiiSquared;
+	TArray<TPair<float, int32>> AwakeByDistance;
+
+	FDelegateHandle LevelAddedHandle;
+	float TimeSinceUpdate = 0.0f;
+	int32 NumActive = 0;
+};
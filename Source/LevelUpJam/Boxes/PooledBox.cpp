@@ -0,0 +1,44 @@
+#include "PooledBox.h"
+
+#include "LevelUpJam.h"
+#include "Components/StaticMeshComponent.h"
+
+APooledBox::APooledBox()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh"));
+	RootComponent = Mesh;
+	Mesh->SetMobility(EComponentMobility::Movable);
+	Mesh->SetCollisionProfileName(LevelUpJamCollision::PhysicsBoxProfile);
+	Mesh->SetGenerateOverlapEvents(true);
+	Mesh->SetSimulatePhysics(true);
+}
+
+void APooledBox::ActivateFromPool(const FTransform& Transform, const FVector& Velocity)
+{
+	bInPool = false;
+
+	SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	Mesh->SetSimulatePhysics(true);
+	Mesh->SetPhysicsLinearVelocity(Velocity);
+	Mesh->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+	Mesh->WakeRigidBody();
+
+	BP_OnActivatedFromPool();
+}
+
+void APooledBox::ReturnToPool(const FVector& ParkingLocation)
+{
+	bInPool = true;
+
+	Mesh->SetSimulatePhysics(false);
+	SetActorEnableCollision(false);
+	SetActorHiddenInGame(true);
+	SetActorLocation(ParkingLocation, false, nullptr, ETeleportType::ResetPhysics);
+
+	BP_OnReturnedToPool();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "PooledBox.generated.h"
+
+class UStaticMeshComponent;
+
+/**
+ * A physics box owned by UBoxPoolSubsystem. Instead of being destroyed it is parked, hidden and
+ * frozen, then reset and handed out again by the next spawner that needs a box.
+ */
+UCLASS(Blueprintable)
+class LEVELUPJAM_API APooledBox : public AActor
+{
+	GENERATED_BODY()
+	
+public:
+	APooledBox();
+
+	UStaticMeshComponent* GetMesh() const { return Mesh; }
+
+	UFUNCTION(BlueprintPure, Category = "BoxPool")
+	bool IsInPool() const { return bInPool; }
+
+	/** Puts the box into play at the transform, with physics reset. */
+	virtual void ActivateFromPool(const FTransform& Transform, const FVector& Velocity);
+
+	/** Freezes and hides the box so it can wait in the pool. */
+	virtual void ReturnToPool(const FVector& ParkingLocation);
+
+protected:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "BoxPool")
+	TObjectPtr<UStaticMeshComponent> Mesh;
+
+	// Blueprint hooks for effects when a box enters or leaves play
+	UFUNCTION(BlueprintImplementableEvent, Category = "BoxPool")
+	void BP_OnActivatedFromPool();
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "BoxPool")
+	void BP_OnReturnedToPool();
+
+	bool bInPool = false;
+};
@@ -0,0 +1,105 @@
+#include "ConveyorSegment.h"
+
+#include "ConveyorSubsystem.h"
+#include "Boxes/BoxPoolSubsystem.h"
+#include "Boxes/PooledBox.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+
+AConveyorSegment::AConveyorSegment()
+{
+	// Belts are simulated by UConveyorSubsystem, not per actor
+	PrimaryActorTick.bCanEverTick = false;
+
+	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	RootComponent = Root;
+
+	ItemInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("ItemInstances"));
+	ItemInstances->SetupAttachment(RootComponent);
+	ItemInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	ItemInstances->SetMobility(EComponentMobility::Movable);
+}
+
+void AConveyorSegment::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ItemInstances->SetStaticMesh(ItemMesh);
+
+	if (UConveyorSubsystem* Conveyors = GetWorld()->GetSubsystem<UConveyorSubsystem>())
+	{
+		Conveyors->RegisterSegment(this);
+	}
+}
+
+void AConveyorSegment::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UConveyorSubsystem* Conveyors = GetWorld()->GetSubsystem<UConveyorSubsystem>())
+	{
+		Conveyors->UnregisterSegment(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool AConveyorSegment::TryAddItem()
+{
+	UConveyorSubsystem* Conveyors = GetWorld()->GetSubsystem<UConveyorSubsystem>();
+	return Conveyors && Conveyors->TryAddItem(LaneIndex);
+}
+
+int32 AConveyorSegment::GetNumItems() const
+{
+	const UConveyorSubsystem* Conveyors = GetWorld()->GetSubsystem<UConveyorSubsystem>();
+	return Conveyors ? Conveyors->GetNumItems(LaneIndex) : 0;
+}
+
+void AConveyorSegment::EjectItem(float OverrunDistance)
+{
+	UBoxPoolSubsystem* Pool = GetWorld()->GetSubsystem<UBoxPoolSubsystem>();
+	if (!Pool)
+	{
+		return;
+	}
+
+	// The item keeps the belt velocity as it becomes a physics body
+	const FVector Location = GetActorTransform().TransformPosition(FVector(Length + OverrunDistance, 0.0f, ItemHeight));
+	Pool->AcquireBox(EjectedBoxClass, FTransform(GetActorRotation(), Location), ItemMesh, GetActorForwardVector() * Speed);
+}
+
+void AConveyorSegment::UpdateItemInstances(TConstArrayView<float> Positions)
+{
+	const int32 NumItems = Positions.Num();
+	const int32 NumInstances = ItemInstances->GetInstanceCount();
+
+	if (NumItems == 0 && NumInstances == 0)
+	{
+		return;
+	}
+
+	InstanceTransforms.SetNum(NumItems, EAllowShrinking::No);
+	for (int32 Index = 0; Index < NumItems; ++Index)
+	{
+		InstanceTransforms[Index] = FTransform(FVector(Positions[Index], 0.0f, ItemHeight));
+	}
+
+	// Keep one instance per item; surplus instances are trimmed from the end so indices stay stable
+	if (NumInstances > NumItems)
+	{
+		TArray<int32> Surplus;
+		for (int32 Index = NumItems; Index < NumInstances; ++Index)
+		{
+			Surplus.Add(Index);
+		}
+		ItemInstances->RemoveInstances(Surplus);
+	}
+	else if (NumItems > NumInstances)
+	{
+		ItemInstances->AddInstances(TArray<FTransform>(InstanceTransforms.GetData() + NumInstances, NumItems - NumInstances), false);
+	}
+
+	if (NumItems > 0)
+	{
+		ItemInstances->BatchUpdateInstancesTransforms(0, InstanceTransforms, false, true, false);
+	}
+}
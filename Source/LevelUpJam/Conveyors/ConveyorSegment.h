@@ -0,0 +1,86 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ConveyorSegment.generated.h"
+
+class APooledBox;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+/**
+ * A straight conveyor belt running along the actor's forward axis. Items on the belt are not
+ * actors: they are positions along the segment, simulated for every belt at once by
+ * UConveyorSubsystem and drawn as instances. Items only become physics actors, taken from the box
+ * pool, when they leave a belt that has no next segment.
+ */
+UCLASS()
+class LEVELUPJAM_API AConveyorSegment : public AActor
+{
+	GENERATED_BODY()
+	
+public:
+	AConveyorSegment();
+
+	/** Belt length in cm, along the forward axis. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Conveyor")
+	float Length = 1000.0f;
+
+	/** Belt speed in cm/s. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Conveyor")
+	float Speed = 200.0f;
+
+	/** Minimum distance between two items on the belt. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Conveyor")
+	float ItemSpacing = 100.0f;
+
+	/** Height of the item pivot above the belt origin. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Conveyor")
+	float ItemHeight = 50.0f;
+
+	/** Belts this one feeds into. Items are handed out round-robin; with none they are ejected. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Conveyor")
+	TArray<TObjectPtr<AConveyorSegment>> NextSegments;
+
+	/** Items added at the start of the belt per second, 0 to disable. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Conveyor|Feed")
+	float ItemsPerSecond = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Conveyor|Items")
+	TObjectPtr<UStaticMesh> ItemMesh;
+
+	/** Box taken from the pool when an item leaves the last belt. ItemMesh is applied to it. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Conveyor|Items")
+	TSubclassOf<APooledBox> EjectedBoxClass;
+
+	/** Adds an item at the start of the belt. Fails when the start is still occupied. */
+	UFUNCTION(BlueprintCallable, Category = "Conveyor")
+	bool TryAddItem();
+
+	UFUNCTION(BlueprintPure, Category = "Conveyor")
+	int32 GetNumItems() const;
+
+	/** Called by the subsystem when an item runs off the end of a belt with no next segment. */
+	virtual void EjectItem(float OverrunDistance);
+
+	/** Called by the subsystem after the simulation step with the item positions, front first. */
+	void UpdateItemInstances(TConstArrayView<float> Positions);
+
+	int32 GetLaneIndex() const { return LaneIndex; }
+	void SetLaneIndex(int32 NewLaneIndex) { LaneIndex = NewLaneIndex; }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY()
+	TObjectPtr<USceneComponent> Root;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Conveyor")
+	TObjectPtr<UInstancedStaticMeshComponent> ItemInstances;
+
+	// Scratch buffer for instance transforms, kept to avoid reallocating every frame
+	TArray<FTransform> InstanceTransforms;
+
+	int32 LaneIndex = INDEX_NONE;
+};
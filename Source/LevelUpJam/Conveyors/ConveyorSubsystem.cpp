@@ -0,0 +1,237 @@
+#include "ConveyorSubsystem.h"
+
+#include "ConveyorSegment.h"
+#include "LevelUpJam.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Conveyor Advance"), STAT_ConveyorAdvance, STATGROUP_LevelUpJam);
+DECLARE_CYCLE_STAT(TEXT("Conveyor Instance Update"), STAT_ConveyorInstanceUpdate, STATGROUP_LevelUpJam);
+
+namespace Conveyor
+{
+	// Below this many belts the parallel dispatch costs more than it saves
+	constexpr int32 MinLanesForParallel = 8;
+}
+
+void UConveyorSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (bGraphDirty)
+	{
+		RebuildGraph();
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ConveyorAdvance);
+
+		// Decide up front which belts may hand their front item on, so the advance needs no cross-belt reads
+		for (FConveyorLane& Lane : Lanes)
+		{
+			if (!Lane.bActive)
+			{
+				continue;
+			}
+
+			if (Lane.NextLanes.IsEmpty())
+			{
+				Lane.bCanExit = true;
+			}
+			else
+			{
+				const FConveyorLane& Target = Lanes[Lane.NextLanes[Lane.NextOutput % Lane.NextLanes.Num()]];
+				Lane.bCanExit = Target.Positions.IsEmpty() || Target.Positions.Last() >= Target.Spacing;
+			}
+		}
+
+		ParallelFor(Lanes.Num(), [this, DeltaTime](int32 LaneIndex)
+		{
+			FConveyorLane& Lane = Lanes[LaneIndex];
+			if (Lane.bActive)
+			{
+				AdvanceLane(Lane, DeltaTime);
+			}
+		}, Lanes.Num() < Conveyor::MinLanesForParallel);
+
+		ResolveExits();
+
+		// Feed after the exits so freshly emptied belt starts can be refilled this frame
+		for (int32 LaneIndex = 0; LaneIndex < Lanes.Num(); ++LaneIndex)
+		{
+			FConveyorLane& Lane = Lanes[LaneIndex];
+			if (!Lane.bActive || Lane.FeedInterval <= 0.0f)
+			{
+				continue;
+			}
+
+			Lane.FeedTimer += DeltaTime;
+			if (Lane.FeedTimer >= Lane.FeedInterval && TryAddItem(LaneIndex))
+			{
+				Lane.FeedTimer -= Lane.FeedInterval;
+			}
+		}
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ConveyorInstanceUpdate);
+
+		for (const FConveyorLane& Lane : Lanes)
+		{
+			if (AConveyorSegment* Segment = Lane.bActive ? Lane.Segment.Get() : nullptr)
+			{
+				Segment->UpdateItemInstances(Lane.Positions);
+			}
+		}
+	}
+
+	CSV_CUSTOM_STAT(LevelUpJam, ConveyorItems, GetTotalItems(), ECsvCustomStatOp::Set);
+}
+
+TStatId UConveyorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UConveyorSubsystem, STATGROUP_Tickables);
+}
+
+void UConveyorSubsystem::AdvanceLane(FConveyorLane& Lane, float DeltaTime) const
+{
+	Lane.ExitOverrun = -1.0f;
+
+	const float Step = Lane.Speed * DeltaTime;
+	float Limit = Lane.bCanExit ? TNumericLimits<float>::Max() : Lane.Length;
+
+	for (int32 Index = 0; Index < Lane.Positions.Num(); ++Index)
+	{
+		float& Position = Lane.Positions[Index];
+		Position = FMath::Max(Position, FMath::Min(Position + Step, Limit));
+
+		if (Index == 0 && Position >= Lane.Length && Lane.bCanExit)
+		{
+			Lane.ExitOverrun = Position - Lane.Length;
+		}
+
+		// Items queue up behind the one in front, and only the front item may leave per frame
+		Limit = FMath::Min(Position - Lane.Spacing, Lane.Length);
+	}
+}
+
+void UConveyorSubsystem::ResolveExits()
+{
+	for (FConveyorLane& Lane : Lanes)
+	{
+		if (!Lane.bActive || Lane.ExitOverrun < 0.0f)
+		{
+			continue;
+		}
+
+		if (Lane.NextLanes.IsEmpty())
+		{
+			if (AConveyorSegment* Segment = Lane.Segment.Get())
+			{
+				Segment->EjectItem(Lane.ExitOverrun);
+			}
+			Lane.Positions.RemoveAt(0, EAllowShrinking::No);
+			continue;
+		}
+
+		// Another belt may have taken the space this frame, in which case the item waits at the end
+		FConveyorLane& Target = Lanes[Lane.NextLanes[Lane.NextOutput % Lane.NextLanes.Num()]];
+		const float TargetTail = Target.Positions.IsEmpty() ? Target.Length + Target.Spacing : Target.Positions.Last();
+		if (TargetTail < Target.Spacing)
+		{
+			Lane.Positions[0] = Lane.Length;
+			continue;
+		}
+
+		Target.Positions.Add(FMath::Min(Lane.ExitOverrun, TargetTail - Target.Spacing));
+		Lane.Positions.RemoveAt(0, EAllowShrinking::No);
+		Lane.NextOutput = (Lane.NextOutput + 1) % Lane.NextLanes.Num();
+	}
+}
+
+void UConveyorSubsystem::RebuildGraph()
+{
+	bGraphDirty = false;
+
+	for (FConveyorLane& Lane : Lanes)
+	{
+		Lane.NextLanes.Reset();
+
+		const AConveyorSegment* Segment = Lane.bActive ? Lane.Segment.Get() : nullptr;
+		if (!Segment)
+		{
+			continue;
+		}
+
+		for (const AConveyorSegment* Next : Segment->NextSegments)
+		{
+			if (Next && Next->GetLaneIndex() != INDEX_NONE)
+			{
+				Lane.NextLanes.Add(Next->GetLaneIndex());
+			}
+		}
+		Lane.NextOutput = 0;
+	}
+}
+
+void UConveyorSubsystem::RegisterSegment(AConveyorSegment* Segment)
+{
+	const int32 LaneIndex = FreeLanes.IsEmpty() ? Lanes.AddDefaulted() : FreeLanes.Pop();
+
+	FConveyorLane& Lane = Lanes[LaneIndex];
+	Lane = FConveyorLane();
+	Lane.Segment = Segment;
+	Lane.Length = Segment->Length;
+	Lane.Speed = Segment->Speed;
+	Lane.Spacing = FMath::Max(1.0f, Segment->ItemSpacing);
+	Lane.FeedInterval = Segment->ItemsPerSecond > 0.0f ? 1.0f / Segment->ItemsPerSecond : 0.0f;
+	Lane.bActive = true;
+
+	Segment->SetLaneIndex(LaneIndex);
+	bGraphDirty = true;
+}
+
+void UConveyorSubsystem::UnregisterSegment(AConveyorSegment* Segment)
+{
+	const int32 LaneIndex = Segment->GetLaneIndex();
+	if (!Lanes.IsValidIndex(LaneIndex))
+	{
+		return;
+	}
+
+	Lanes[LaneIndex] = FConveyorLane();
+	FreeLanes.Add(LaneIndex);
+	Segment->SetLaneIndex(INDEX_NONE);
+	bGraphDirty = true;
+}
+
+bool UConveyorSubsystem::TryAddItem(int32 LaneIndex)
+{
+	if (!Lanes.IsValidIndex(LaneIndex) || !Lanes[LaneIndex].bActive)
+	{
+		return false;
+	}
+
+	FConveyorLane& Lane = Lanes[LaneIndex];
+	if (!Lane.Positions.IsEmpty() && Lane.Positions.Last() < Lane.Spacing)
+	{
+		return false;
+	}
+
+	Lane.Positions.Add(0.0f);
+	return true;
+}
+
+int32 UConveyorSubsystem::GetNumItems(int32 LaneIndex) const
+{
+	return Lanes.IsValidIndex(LaneIndex) ? Lanes[LaneIndex].Positions.Num() : 0;
+}
+
+int32 UConveyorSubsystem::GetTotalItems() const
+{
+	int32 Total = 0;
+	for (const FConveyorLane& Lane : Lanes)
+	{
+		Total += Lane.Positions.Num();
+	}
+	return Total;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ConveyorSubsystem.generated.h"
+
+class AConveyorSegment;
+
+/** Simulation data for one belt. Item positions are stored front first, in cm from the belt start. */
+struct FConveyorLane
+{
+	TWeakObjectPtr<AConveyorSegment> Segment;
+	TArray<float> Positions;
+	TArray<int32, TInlineAllocator<2>> NextLanes;
+
+	float Length = 0.0f;
+	float Speed = 0.0f;
+	float Spacing = 0.0f;
+	float FeedInterval = 0.0f;
+	float FeedTimer = 0.0f;
+	int32 NextOutput = 0;
+
+	// Set before the parallel advance: whether the front item may leave the belt this frame
+	bool bCanExit = false;
+
+	// Distance the front item ran past the end this frame, negative when nothing exited
+	float ExitOverrun = -1.0f;
+
+	bool bActive = false;
+};
+
+/**
+ * Advances every conveyor belt in the world in one pass per frame. Belts form a graph through
+ * AConveyorSegment::NextSegments; the per-belt advance runs in parallel and hand-offs between
+ * belts are resolved afterwards on the game thread.
+ */
+UCLASS()
+class LEVELUPJAM_API UConveyorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterSegment(AConveyorSegment* Segment);
+	void UnregisterSegment(AConveyorSegment* Segment);
+
+	bool TryAddItem(int32 LaneIndex);
+	int32 GetNumItems(int32 LaneIndex) const;
+
+	UFUNCTION(BlueprintPure, Category = "Conveyor")
+	int32 GetTotalItems() const;
+
+private:
+	void RebuildGraph();
+	void AdvanceLane(FConveyorLane& Lane, float DeltaTime) const;
+	void ResolveExits();
+
+	TArray<FConveyorLane> Lanes;
+	TArray<int32> FreeLanes;
+	bool bGraphDirty = false;
+};
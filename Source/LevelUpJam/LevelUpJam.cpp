@@ -2,5 +2,62 @@
 
 #include "LevelUpJam.h"
 #include "Modules/ModuleManager.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY(LogLevelUpJam);
+
+CSV_DEFINE_CATEGORY_MODULE(LEVELUPJAM_API, LevelUpJam, true);
+
+namespace LevelUpJamCounters
+{
+	int32 Values[static_cast<int32>(ECounter::Num)] = {};
+
+	const TCHAR* GetName(ECounter Counter)
+	{
+		switch (Counter)
+		{
+		case ECounter::DroneTicks:		return TEXT("DroneTicks");
+		case ECounter::ObstacleTicks:	return TEXT("ObstacleTicks");
+		case ECounter::LineTraces:		return TEXT("LineTraces");
+		case ECounter::OverlapEvents:	return TEXT("OverlapEvents");
+		case ECounter::ObstacleEvents:	return TEXT("ObstacleEvents");
+		case ECounter::ReplicatedStates:	return TEXT("ReplicatedStates");
+		case ECounter::SuppressedActivations:	return TEXT("SuppressedActivations");
+		case ECounter::ColliderUpdates:	return TEXT("ColliderUpdates");
+		default:						return TEXT("Unknown");
+		}
+	}
+
+	void Reset()
+	{
+		FMemory::Memzero(Values);
+	}
+}
+
+namespace LevelUpJamReplay
+{
+	double GetStateTime(const UWorld* World)
+	{
+		if (!World)
+		{
+			return 0.0;
+		}
+
+		const AGameStateBase* GameState = World->GetGameState();
+		return GameState ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+	}
+
+	bool IsRecordingState(const UWorld* World)
+	{
+		return World && (World->GetNetDriver() || World->GetDemoNetDriver());
+	}
+
+	FString GetReplayFilePath(const FString& Name)
+	{
+		return FPaths::ProjectSavedDir() / TEXT("Demos") / Name + TEXT(".replay");
+	}
+}
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, LevelUpJam, "LevelUpJam" );
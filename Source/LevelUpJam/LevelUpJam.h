@@ -3,4 +3,79 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "ProfilingDebugging/CsvProfiler.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogLevelUpJam, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("LevelUpJam"), STATGROUP_LevelUpJam, STATCAT_Advanced);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(LEVELUPJAM_API, LevelUpJam);
+
+// Object channels and collision profiles declared in DefaultEngine.ini. Triggers only overlap the
+// object types they care about, so irrelevant pairs are rejected by the broadphase instead of in
+// overlap handlers.
+namespace LevelUpJamCollision
+{
+	// The player keeps the Pawn object type, content responds to and queries Pawn for it
+	constexpr ECollisionChannel Drone = ECC_GameTraceChannel2;
+	constexpr ECollisionChannel PhysicsBox = ECC_GameTraceChannel3;
+	constexpr ECollisionChannel Trigger = ECC_GameTraceChannel4;
+
+	inline const FName PlayerProfile = TEXT("Player");
+	inline const FName DroneProfile = TEXT("Drone");
+	inline const FName PhysicsBoxProfile = TEXT("PhysicsBox");
+	// Overlaps players only
+	inline const FName PlayerTriggerProfile = TEXT("PlayerTrigger");
+	// Overlaps players, drones and physics objects
+	inline const FName ObjectTriggerProfile = TEXT("ObjectTrigger");
+}
+
+// Drones and obstacles replicate compact state stamped with this clock instead of transforms, so
+// a replay (or a client) rebuilds their motion from the state and its age, also after a scrub.
+class UWorld;
+
+namespace LevelUpJamReplay
+{
+	// Server world time, which replays reproduce
+	LEVELUPJAM_API double GetStateTime(const UWorld* World);
+
+	// Whether a net or replay driver currently consumes replicated state
+	LEVELUPJAM_API bool IsRecordingState(const UWorld* World);
+
+	// File written by the local replay streamer for a replay name
+	LEVELUPJAM_API FString GetReplayFilePath(const FString& Name);
+}
+
+// Cheap per-frame gameplay counters. The benchmark harness samples and resets them every frame
+// and mirrors them into CSV captures.
+namespace LevelUpJamCounters
+{
+	enum class ECounter : uint8
+	{
+		DroneTicks,
+		ObstacleTicks,
+		LineTraces,
+		OverlapEvents,
+		ObstacleEvents,
+		ReplicatedStates,
+		SuppressedActivations,
+		ColliderUpdates,
+		Num
+	};
+
+	LEVELUPJAM_API extern int32 Values[static_cast<int32>(ECounter::Num)];
+
+	FORCEINLINE void Increment(ECounter Counter, int32 Amount = 1)
+	{
+		Values[static_cast<int32>(Counter)] += Amount;
+	}
+
+	FORCEINLINE int32 Get(ECounter Counter)
+	{
+		return Values[static_cast<int32>(Counter)];
+	}
+
+	LEVELUPJAM_API const TCHAR* GetName(ECounter Counter);
+	LEVELUPJAM_API void Reset();
+}
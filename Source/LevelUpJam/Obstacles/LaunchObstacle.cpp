@@ -1,5 +1,10 @@
 #include "LaunchObstacle.h"
 
+#include "BoxCharacter.h"
+#include "DamageSubsystem.h"
+#include "LevelUpJam.h"
+#include "Boxes/PhysicsBudgetSubsystem.h"
+#include "Boxes/PooledBox.h"
 #include "Components/BoxComponent.h"
 #include "Components/PrimitiveComponent.h"
 #include "Components/SphereComponent.h"
@@ -10,9 +15,7 @@ ALaunchObstacle::ALaunchObstacle()
 	PrimaryActorTick.bCanEverTick = true;
 
 	TriggerComponent = CreateDefaultSubobject<USphereComponent>(TEXT("Trigger"));
-	TriggerComponent->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-	TriggerComponent->SetCollisionResponseToAllChannels(ECR_Ignore);
-	TriggerComponent->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
+	TriggerComponent->SetCollisionProfileName(LevelUpJamCollision::PlayerTriggerProfile);
 	TriggerComponent->SetupAttachment(RootComponent);
 }
 
@@ -28,18 +31,34 @@ void ALaunchObstacle::BeginPlay()
 	Collider->OnComponentEndOverlap.AddDynamic(this, &ALaunchObstacle::OnLaunchEndOverlap);
 	
 	TriggerComponent->OnComponentBeginOverlap.AddDynamic(this, &ALaunchObstacle::HandleBeginOverlap);
-	
+
+	if (UPhysicsBudgetSubsystem* PhysicsBudget = GetWorld()->GetSubsystem<UPhysicsBudgetSubsystem>())
+	{
+		PhysicsBudget->RegisterWakeSource(this);
+	}
 }
 
-void ALaunchObstacle::Tick(float DeltaTime)
+void ALaunchObstacle::TickObstacle(float DeltaTime)
 {
-	Super::Tick(DeltaTime);
+	Super::TickObstacle(DeltaTime);
 
 	if (bApplyContinuousLaunch)
 	{
 		for (UPrimitiveComponent* Comp : OverlappingComponents)
 		{
-			if (IsValid(Comp) && Comp->IsSimulatingPhysics())
+			if (!IsValid(Comp) || !Comp->IsSimulatingPhysics())
+			{
+				continue;
+			}
+
+			// On the fixed step clock a force is integrated over the step as a velocity change, a
+			// force added several times in one frame would only act on the next physics substep.
+			// Impulses are applied once per step, like once per frame without the fixed step.
+			if (IsUsingFixedStep() && !bUseImpulse)
+			{
+				Comp->AddImpulse(LaunchDirection.GetSafeNormal() * LaunchStrength * DeltaTime, NAME_None, true);
+			}
+			else
 			{
 				ApplyLaunchToComponent(Comp);
 			}
@@ -50,7 +69,7 @@ void ALaunchObstacle::Tick(float DeltaTime)
 void ALaunchObstacle::HandleBeginOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor,
 	UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
-	if (bShouldMoveTowardsTarget == true)
+	if (bShouldMoveTowardsTarget == true && HasAuthority())
 	{
 		MoveTowardsTargetActor(OtherActor);
 		LaunchDirection = MoveDirection;
@@ -63,17 +82,43 @@ void ALaunchObstacle::OnLaunchBeginOverlap(UPrimitiveComponent* OverlappedComp,
                                            UPrimitiveComponent* OtherComp, int32 OtherBodyIndex,
                                            bool bFromSweep, const FHitResult& SweepResult)
 {
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::OverlapEvents);
+
+	// Launched characters and bodies replicate on their own
+	if (!HasAuthority())
+	{
+		return;
+	}
+
 	//Launch player characters
 	if (ACharacter* Char = Cast<ACharacter>(OtherActor); Char && Char->IsPlayerControlled())
 	{
 		Char->LaunchCharacter(LaunchDirection * LaunchStrength, false, false);
+
+		if (ABoxCharacter* BoxChar = Cast<ABoxCharacter>(Char))
+		{
+			if (UDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UDamageSubsystem>())
+			{
+				DamageSubsystem->QueueDamage(BoxChar, EDamageKind::Launch, this);
+			}
+		}
 		return;
 	}
 	
-	if (!OtherComp || !OtherComp->IsSimulatingPhysics())
+	// A box recycled earlier in this overlap pass is parked, waking it would bring it back to life outside the pool
+	if (const APooledBox* PooledBox = Cast<APooledBox>(OtherActor); PooledBox && PooledBox->IsInPool())
+	{
+		return;
+	}
+
+	// Boxes frozen by the physics budget are woken up so they can still be launched
+	UPhysicsBudgetSubsystem* PhysicsBudget = GetWorld()->GetSubsystem<UPhysicsBudgetSubsystem>();
+	const bool bSimulating = OtherComp && (PhysicsBudget ? PhysicsBudget->WakeBody(OtherComp) : OtherComp->IsSimulatingPhysics());
+	if (!bSimulating)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("LaunchObstacle: '%s' overlapped, but component '%s' does not simulate physics."),
-	   *OtherActor->GetName(), *OtherComp->GetName());
+		// Static geometry overlaps launch pads all the time, this is not worth a warning
+		UE_LOG(LogLevelUpJam, Verbose, TEXT("LaunchObstacle: '%s' overlapped, but component '%s' does not simulate physics."),
+			*GetNameSafe(OtherActor), *GetNameSafe(OtherComp));
 		return;
 	}
 
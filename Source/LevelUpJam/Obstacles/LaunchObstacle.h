@@ -42,7 +42,7 @@ protected:
 	TSet<UPrimitiveComponent*> OverlappingComponents;
 
 	virtual void BeginPlay() override;
-    virtual void Tick(float DeltaTime) override;
+	virtual void TickObstacle(float DeltaTime) override;
 	
 	virtual void HandleBeginOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor,
 	                                UPrimitiveComponent* OtherComp, int32 OtherBodyIndex,
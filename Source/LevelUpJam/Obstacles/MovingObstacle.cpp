@@ -1,6 +1,13 @@
 #include "MovingObstacle.h"
 
+#include "LevelUpJam.h"
 #include "Components/BoxComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Net/UnrealNetwork.h"
+
+DECLARE_CYCLE_STAT(TEXT("Obstacle Transform Update"), STAT_ObstacleTransformUpdate, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Obstacle Collider Updates"), STAT_ObstacleColliderUpdates, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Obstacle Mesh-Only Updates"), STAT_ObstacleMeshUpdates, STATGROUP_LevelUpJam);
 
 AMovingObstacle::AMovingObstacle()
 {
@@ -37,27 +44,129 @@ void AMovingObstacle::BeginPlay()
 
 	// Store the original position
 	StartLocation = Collider->GetRelativeLocation();
+	SimLocation = StartLocation;
+	PreviousSimLocation = StartLocation;
+	MeshRelativeLocation = Mesh->GetRelativeLocation();
 }
 
-void AMovingObstacle::Tick(float DeltaTime)
+void AMovingObstacle::TickObstacle(float DeltaTime)
 {
-	Super::Tick(DeltaTime);
+	PreviousSimLocation = SimLocation;
 
 	if (!bShouldMove)
 		return;
 
-	FVector CurrentLocation = Collider->GetRelativeLocation();
 	FVector DesiredLocation = bMovingUp ? StartLocation + (MoveDirection * MoveAmount) : StartLocation;
 
-	FVector NewLocation = FMath::VInterpTo(CurrentLocation, DesiredLocation, DeltaTime, MoveSpeed);
-	Collider->SetRelativeLocation(NewLocation);
+	SimLocation = FMath::VInterpTo(SimLocation, DesiredLocation, DeltaTime, MoveSpeed);
 
 	// Stop moving when close enough
-	if (FVector::Dist(NewLocation, DesiredLocation) < 1.0f)
+	if (FVector::Dist(SimLocation, DesiredLocation) < 1.0f)
 	{
-		Collider->SetRelativeLocation(DesiredLocation);
+		SimLocation = DesiredLocation;
 		bShouldMove = false;
 	}
+
+	// On the fixed step clock the collider is moved in PresentFixedStep
+	if (!IsUsingFixedStep())
+	{
+		ApplySimLocation(SimLocation);
+	}
+}
+
+void AMovingObstacle::PresentFixedStep(float Alpha)
+{
+	ApplySimLocation(FMath::Lerp(PreviousSimLocation, SimLocation, Alpha));
+}
+
+void AMovingObstacle::ApplySimLocation(const FVector& Location, bool bForce)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ObstacleTransformUpdate);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const bool bAtEndpoint = !bShouldMove && Location.Equals(SimLocation);
+	const bool bMoveCollider = bForce || bAtEndpoint || OverlapUpdate == EObstacleOverlapUpdate::EveryMove
+		|| (OverlapUpdate == EObstacleOverlapUpdate::FixedRate && Now - LastColliderUpdateTime >= 1.0 / FMath::Max(OverlapUpdateRate, 1.0f));
+
+	if (!bMoveCollider)
+	{
+		// The mesh is attached to the collider, offset it by how far the collider lags behind
+		const FVector Lag = Collider->GetRelativeTransform().InverseTransformVector(Location - Collider->GetRelativeLocation());
+		const FVector MeshLocation = MeshRelativeLocation + Lag;
+		if (!MeshLocation.Equals(Mesh->GetRelativeLocation()))
+		{
+			Mesh->SetRelativeLocation(MeshLocation);
+			INC_DWORD_STAT(STAT_ObstacleMeshUpdates);
+		}
+		return;
+	}
+
+	LastColliderUpdateTime = Now;
+	if (Location.Equals(Collider->GetRelativeLocation()) && Mesh->GetRelativeLocation().Equals(MeshRelativeLocation))
+	{
+		return;
+	}
+
+	{
+		// Collider and mesh refresh their overlaps and transforms once, when the scope ends
+		FScopedMovementUpdate ScopedUpdate(Collider, EScopedUpdate::DeferredUpdates);
+		Mesh->SetRelativeLocation(MeshRelativeLocation);
+		Collider->SetRelativeLocation(Location);
+	}
+
+	INC_DWORD_STAT(STAT_ObstacleColliderUpdates);
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::ColliderUpdates);
+}
+
+void AMovingObstacle::SnapMovement()
+{
+	SimLocation = bMovingUp ? StartLocation + (MoveDirection * MoveAmount) : StartLocation;
+	PreviousSimLocation = SimLocation;
+	bShouldMove = false;
+	ApplySimLocation(SimLocation, true);
+}
+
+uint8 AMovingObstacle::GetReplicatedProgress() const
+{
+	const FVector MoveOffset = MoveDirection * MoveAmount;
+	if (MoveOffset.IsNearlyZero())
+	{
+		return 0;
+	}
+
+	const float Progress = FVector::DotProduct(SimLocation - StartLocation, MoveOffset) / MoveOffset.SizeSquared();
+	return static_cast<uint8>(FMath::RoundToInt32(FMath::Clamp(Progress, 0.0f, 1.0f) * 255.0f));
+}
+
+void AMovingObstacle::RestoreReplicatedState(float StateAge)
+{
+	const FVector MovedLocation = StartLocation + (MoveDirection * MoveAmount);
+	const FVector FromLocation = FMath::Lerp(StartLocation, MovedLocation, ReplicatedState.Progress / 255.0f);
+	const FVector DesiredLocation = bMovingUp ? MovedLocation : StartLocation;
+
+	// VInterpTo closes the remaining distance exponentially
+	SimLocation = DesiredLocation + (FromLocation - DesiredLocation) * FMath::Exp(-MoveSpeed * StateAge);
+	bShouldMove = FVector::Dist(SimLocation, DesiredLocation) >= 1.0f;
+	if (!bShouldMove)
+	{
+		SimLocation = DesiredLocation;
+	}
+
+	PreviousSimLocation = SimLocation;
+	ApplySimLocation(SimLocation, true);
+}
+
+void AMovingObstacle::OnRep_ReplicatedMoveDirection()
+{
+	MoveDirection = ReplicatedMoveDirection;
+	RestoreReplicatedState(GetReplicatedStateAge());
+}
+
+void AMovingObstacle::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AMovingObstacle, ReplicatedMoveDirection);
 }
 
 void AMovingObstacle::MoveTowardsTargetActor(AActor* Actor)
@@ -65,4 +174,10 @@ void AMovingObstacle::MoveTowardsTargetActor(AActor* Actor)
 	MoveDirection =  Actor->GetActorLocation() - GetActorLocation();
 	MoveDirection.Normalize();
 	MoveDirection.Z = 0;
+
+	// Sent with the state change that follows
+	if (HasAuthority())
+	{
+		ReplicatedMoveDirection = MoveDirection;
+	}
 }
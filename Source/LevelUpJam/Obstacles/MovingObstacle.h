@@ -2,8 +2,21 @@
 
 #include "CoreMinimal.h"
 #include "Obstacle.h"
+#include "Engine/NetSerialization.h"
 #include "MovingObstacle.generated.h"
 
+// How closely the trigger collider, and with it the overlap updates, follows the movement
+UENUM()
+enum class EObstacleOverlapUpdate : uint8
+{
+	// The collider moves every frame
+	EveryMove,
+	// Only the mesh moves, the collider catches up when the movement ends
+	Endpoints,
+	// Like Endpoints, plus the collider catches up OverlapUpdateRate times per second
+	FixedRate
+};
+
 /**
  * 
  */
@@ -28,6 +41,14 @@ public:
 	/** How far the door moves up. */
 	UPROPERTY(EditAnywhere, Category = "Obstacle|Move")
 	FVector MoveDirection = FVector(0,0,1);
+
+	/** Moving the collider re-runs its overlaps; the mesh, which blocks, always moves. */
+	UPROPERTY(EditAnywhere, Category = "Obstacle|Move")
+	EObstacleOverlapUpdate OverlapUpdate = EObstacleOverlapUpdate::EveryMove;
+
+	/** Collider updates per second while moving with FixedRate. */
+	UPROPERTY(EditAnywhere, Category = "Obstacle|Move", meta = (ClampMin = "1", EditCondition = "OverlapUpdate == EObstacleOverlapUpdate::FixedRate"))
+	float OverlapUpdateRate = 10.0f;
 	
 	AMovingObstacle();
 
@@ -35,13 +56,38 @@ public:
 	virtual void Activate() override;
 	virtual void Deactivate() override;
 	virtual void SetupAutoLoop() override;
+	virtual void TickObstacle(float DeltaTime) override;
+	virtual void SnapMovement() override;
 	
 protected:
 	virtual void BeginPlay() override;
-	virtual void Tick(float DeltaTime) override;
+	virtual void PresentFixedStep(float Alpha) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual uint8 GetReplicatedProgress() const override;
+	virtual void RestoreReplicatedState(float StateAge) override;
 	virtual void MoveTowardsTargetActor(AActor* Actor);
 
+	// MoveDirection when it is aimed at runtime, quantized
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedMoveDirection)
+	FVector_NetQuantizeNormal ReplicatedMoveDirection;
+
+	UFUNCTION()
+	void OnRep_ReplicatedMoveDirection();
+
+	// Moves the collider to Location, or only the mesh while OverlapUpdate lets the collider lag.
+	// bForce always moves the collider.
+	void ApplySimLocation(const FVector& Location, bool bForce = false);
+
 	// Internal state flags
 	bool bMovingUp = false;
 	bool bShouldMove = false;
+
+	// Simulated collider location, and the one of the previous fixed step for interpolation
+	FVector SimLocation = FVector::ZeroVector;
+	FVector PreviousSimLocation = FVector::ZeroVector;
+
+private:
+	// Mesh offset from the collider when they are in sync
+	FVector MeshRelativeLocation = FVector::ZeroVector;
+	double LastColliderUpdateTime = 0.0;
 };
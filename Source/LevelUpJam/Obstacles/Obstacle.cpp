@@ -1,9 +1,19 @@
 #include "Obstacle.h"
 
+#include "ObstacleEffectsSubsystem.h"
+#include "ObstacleEventBus.h"
+#include "DormancySubsystem.h"
+#include "FixedStepSubsystem.h"
+#include "LevelUpJam.h"
 #include "Components/BoxComponent.h"
 #include "GameFramework/Character.h"
 #include "Kismet/GameplayStatics.h"
+#include "Net/UnrealNetwork.h"
+#include "Particles/ParticleSystem.h"
+#include "Sound/SoundBase.h"
+#include "Templates/UnrealTemplate.h"
 #include "NiagaraFunctionLibrary.h"
+#include "NiagaraSystem.h"
 
 AObstacle::AObstacle()
 {
@@ -13,9 +23,7 @@ AObstacle::AObstacle()
 	RootComponent = Root;
 	
 	Collider = CreateDefaultSubobject<UBoxComponent>(TEXT("Collider"));
-	Collider->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-	Collider->SetCollisionResponseToAllChannels(ECR_Ignore);
-	Collider->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
+	Collider->SetCollisionProfileName(LevelUpJamCollision::PlayerTriggerProfile);
 	Collider->SetupAttachment(RootComponent);
 
 	Mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh"));
@@ -23,15 +31,33 @@ AObstacle::AObstacle()
 	Mesh->SetCollisionResponseToAllChannels(ECR_Ignore);
 	Mesh->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);*/
 	Mesh->SetupAttachment(Collider);
+
+	// Only state changes replicate, flushed from dormancy when they happen
+	bReplicates = true;
+	SetReplicatingMovement(false);
+	NetDormancy = DORM_DormantAll;
 }
 
 void AObstacle::Activate()
 {
+	if (State != EObstacleState::Disabled)
+	{
+		State = EObstacleState::Active;
+	}
+
 	OnActivated.Broadcast();
+	OnActivatedNative.Broadcast(this);
+	PostEvent(EObstacleEvent::Activated);
+	UpdateReplicatedState(true);
 
-	if (AutoResetDeactivationDelay > 0.0f) // Deactivate after a delay > 0
+	if (AutoResetDeactivationDelay > 0.0f && !bDrivenByGroup) // Deactivate after a delay > 0
+	{
+		StartLoopTimer(false, AutoResetDeactivationDelay);
+	}
+	else if (!bDrivenByGroup && State == EObstacleState::Active)
 	{
-		GetWorldTimerManager().SetTimer(DeactivationResetTimerHandle, this, &AObstacle::Deactivate, AutoResetDeactivationDelay, false);
+		// Nothing will deactivate it, the activation is a pulse
+		StartCooldown(FMath::Max(CooldownDuration, PulseCooldownDuration));
 	}
 
 	if (bPlayEffectsOnActivate)
@@ -42,49 +68,328 @@ void AObstacle::Activate()
 
 void AObstacle::Deactivate()
 {
+	if (State != EObstacleState::Disabled)
+	{
+		StartCooldown(CooldownDuration);
+	}
+
 	OnDeactivated.Broadcast();
+	OnDeactivatedNative.Broadcast(this);
+	PostEvent(EObstacleEvent::Deactivated);
+	UpdateReplicatedState(false);
+
+	if (AutoResetActivationDelay > 0.0f && !bDrivenByGroup) // Reactivate after a delay > 0
+	{
+		StartLoopTimer(true, AutoResetActivationDelay);
+	}
+}
+
+void AObstacle::StartCooldown(float Duration)
+{
+	State = Duration > 0.0f ? EObstacleState::Cooldown : EObstacleState::Idle;
+	CooldownEndTime = GetWorld()->GetTimeSeconds() + Duration;
+}
+
+bool AObstacle::RequestActivation()
+{
+	// Requests coming in while an overlap delay runs join the pending activation
+	const bool bPending = GetWorldTimerManager().IsTimerActive(OverlapActivationTimerHandle);
+	if (GetObstacleState() != EObstacleState::Idle || bPending || LastRequestFrame == GFrameCounter)
+	{
+		LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::SuppressedActivations);
+		return false;
+	}
+
+	LastRequestFrame = GFrameCounter;
+	if (OverlapActivationDelay > 0.0f)
+	{
+		GetWorldTimerManager().SetTimer(OverlapActivationTimerHandle, this, &AObstacle::Activate, OverlapActivationDelay, false);
+	}
+	else
+	{
+		Activate();
+	}
+	return true;
+}
 
-	if (AutoResetActivationDelay > 0.0f) // Reactivate after a delay > 0
+void AObstacle::SetObstacleEnabled(bool bEnabled)
+{
+	if (bEnabled == (State != EObstacleState::Disabled))
 	{
-		GetWorldTimerManager().SetTimer(ActivationResetTimerHandle, this, &AObstacle::Activate, AutoResetActivationDelay, false);
+		return;
+	}
+
+	if (bEnabled)
+	{
+		State = EObstacleState::Idle;
+		return;
+	}
+
+	State = EObstacleState::Disabled;
+
+	FTimerManager& TimerManager = GetWorldTimerManager();
+	TimerManager.ClearTimer(ActivationResetTimerHandle);
+	TimerManager.ClearTimer(DeactivationResetTimerHandle);
+	TimerManager.ClearTimer(OverlapActivationTimerHandle);
+	FixedLoopRemaining = -1.0f;
+}
+
+EObstacleState AObstacle::GetObstacleState() const
+{
+	if (State == EObstacleState::Cooldown && GetWorld()->GetTimeSeconds() >= CooldownEndTime)
+	{
+		return EObstacleState::Idle;
+	}
+	return State;
+}
+
+void AObstacle::SetDrivenByGroup(bool bDriven)
+{
+	bDrivenByGroup = bDriven;
+
+	if (bDriven)
+	{
+		GetWorldTimerManager().ClearTimer(ActivationResetTimerHandle);
+		GetWorldTimerManager().ClearTimer(DeactivationResetTimerHandle);
+		FixedLoopRemaining = -1.0f;
+	}
+	SetActorTickEnabled(!bDriven);
+}
+
+void AObstacle::EnterDormancy()
+{
+	SetActorTickEnabled(false);
+
+	if (UObstacleEffectsSubsystem* Effects = GetWorld()->GetSubsystem<UObstacleEffectsSubsystem>())
+	{
+		Effects->RemoveInterest(this);
+	}
+
+	// Paused timers keep their remaining time, which is the phase of the auto loop
+	FTimerManager& TimerManager = GetWorldTimerManager();
+	TimerManager.PauseTimer(ActivationResetTimerHandle);
+	TimerManager.PauseTimer(DeactivationResetTimerHandle);
+	TimerManager.PauseTimer(OverlapActivationTimerHandle);
+}
+
+void AObstacle::ExitDormancy(float DormantSeconds)
+{
+	SetActorTickEnabled(!bDrivenByGroup);
+
+	if (UObstacleEffectsSubsystem* Effects = GetWorld()->GetSubsystem<UObstacleEffectsSubsystem>())
+	{
+		Effects->AddInterest(this);
+	}
+
+	FTimerManager& TimerManager = GetWorldTimerManager();
+	TimerManager.UnPauseTimer(OverlapActivationTimerHandle);
+
+	// A pending deactivation means the obstacle was active when it fell asleep
+	const bool bWasActive = TimerManager.TimerExists(DeactivationResetTimerHandle);
+	FTimerHandle& PendingHandle = bWasActive ? DeactivationResetTimerHandle : ActivationResetTimerHandle;
+	if (!TimerManager.TimerExists(PendingHandle))
+	{
+		// Not looping, nothing to catch up on
+		SnapMovement();
+		return;
+	}
+
+	const float Remaining = TimerManager.GetTimerRemaining(PendingHandle);
+	if (DormantSeconds < Remaining)
+	{
+		TimerManager.SetTimer(PendingHandle, this, bWasActive ? &AObstacle::Deactivate : &AObstacle::Activate, Remaining - DormantSeconds, false);
+		SnapMovement();
+		return;
+	}
+
+	// Walk the loop analytically: the pending timer fired, then whole cycles can be skipped
+	bool bActive = !bWasActive;
+	float Elapsed = DormantSeconds - Remaining;
+	if (AutoResetActivationDelay > 0.0f && AutoResetDeactivationDelay > 0.0f)
+	{
+		Elapsed = FMath::Fmod(Elapsed, AutoResetActivationDelay + AutoResetDeactivationDelay);
+	}
+
+	float PhaseDuration = bActive ? AutoResetDeactivationDelay : AutoResetActivationDelay;
+	while (PhaseDuration > 0.0f && Elapsed >= PhaseDuration)
+	{
+		Elapsed -= PhaseDuration;
+		bActive = !bActive;
+		PhaseDuration = bActive ? AutoResetDeactivationDelay : AutoResetActivationDelay;
+	}
+
+	TimerManager.ClearTimer(ActivationResetTimerHandle);
+	TimerManager.ClearTimer(DeactivationResetTimerHandle);
+
+	// Broadcasts the final state once, then restores the phase inside it
+	bActive ? Activate() : Deactivate();
+	SnapMovement();
+
+	if (PhaseDuration > 0.0f)
+	{
+		StartLoopTimer(!bActive, PhaseDuration - Elapsed);
+	}
+
+	// The snap skipped the movement the state change above started
+	UpdateReplicatedState(bActive);
+}
+
+void AObstacle::StartLoopTimer(bool bActivateNext, float Delay)
+{
+	// Copies without authority follow the replicated state instead
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	if (bUseFixedStep)
+	{
+		FixedLoopRemaining = Delay;
+		bFixedLoopActivates = bActivateNext;
+		return;
+	}
+
+	GetWorldTimerManager().SetTimer(bActivateNext ? ActivationResetTimerHandle : DeactivationResetTimerHandle, this,
+		bActivateNext ? &AObstacle::Activate : &AObstacle::Deactivate, Delay, false);
+}
+
+void AObstacle::FixedStep(float StepSeconds)
+{
+	// Dormant and group-driven obstacles have their tick disabled, the group steps its members itself
+	if (!IsActorTickEnabled())
+	{
+		return;
+	}
+
+	if (FixedLoopRemaining >= 0.0f)
+	{
+		FixedLoopRemaining -= StepSeconds;
+		if (FixedLoopRemaining <= 0.0f)
+		{
+			FixedLoopRemaining = -1.0f;
+			bFixedLoopActivates ? Activate() : Deactivate();
+		}
+	}
+
+	TickObstacle(StepSeconds);
+}
+
+void AObstacle::UpdateReplicatedState(bool bActive)
+{
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	ReplicatedState.bActive = bActive;
+	ReplicatedState.Progress = GetReplicatedProgress();
+	ReplicatedState.ChangeTime = LevelUpJamReplay::GetStateTime(GetWorld());
+	FlushNetDormancy();
+
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::ReplicatedStates);
+}
+
+float AObstacle::GetReplicatedStateAge() const
+{
+	return FMath::Max(0.0f, static_cast<float>(LevelUpJamReplay::GetStateTime(GetWorld()) - ReplicatedState.ChangeTime));
+}
+
+void AObstacle::OnRep_ReplicatedState()
+{
+	const float StateAge = GetReplicatedStateAge();
+
+	// Changes reached by scrubbing a replay are long past, they only restore the pose
+	TGuardValue<bool> PlayEffectsGuard(bPlayEffectsOnActivate, bPlayEffectsOnActivate && StateAge < 0.5f);
+	ReplicatedState.bActive ? Activate() : Deactivate();
+
+	RestoreReplicatedState(StateAge);
+}
+
+void AObstacle::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AObstacle, ReplicatedState);
+}
+
+void AObstacle::PostEvent(EObstacleEvent Event)
+{
+	if (UObstacleEventBus* EventBus = GetWorld()->GetSubsystem<UObstacleEventBus>())
+	{
+		EventBus->Post(this, Event);
 	}
 }
 
 void AObstacle::PlayEffects()
+{
+	// Activated before the effects finished streaming in, they play when the load completes
+	if (!AreEffectsLoaded())
+	{
+		if (UObstacleEffectsSubsystem* Effects = GetWorld()->GetSubsystem<UObstacleEffectsSubsystem>())
+		{
+			Effects->DeferEffects(this);
+		}
+		return;
+	}
+
+	SpawnEffects();
+}
+
+void AObstacle::SpawnEffects()
 {
 	FVector SpawnLocation = GetActorLocation();
 
 	// 🔊 Play sound
-	if (ActivateSound)
+	if (USoundBase* Sound = ActivateSound.Get())
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, ActivateSound, SpawnLocation);
+		UGameplayStatics::PlaySoundAtLocation(this, Sound, SpawnLocation);
 	}
 
 	// ✨ Play particle
-	if (CascadeLaunchEffect)
+	if (UParticleSystem* CascadeEffect = CascadeLaunchEffect.Get())
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), CascadeLaunchEffect, SpawnLocation);
+		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), CascadeEffect, SpawnLocation);
 	}
 
 	// 🌌 Play Niagara effect
-	if (NiagaraLaunchEffect)
+	if (UNiagaraSystem* NiagaraEffect = NiagaraLaunchEffect.Get())
 	{
-		UNiagaraFunctionLibrary::SpawnSystemAtLocation(GetWorld(), NiagaraLaunchEffect, SpawnLocation);
+		UNiagaraFunctionLibrary::SpawnSystemAtLocation(GetWorld(), NiagaraEffect, SpawnLocation);
 	}
 }
 
+FObstacleEffectPaths AObstacle::GetEffectPaths() const
+{
+	return { ActivateSound.ToSoftObjectPath(), CascadeLaunchEffect.ToSoftObjectPath(), NiagaraLaunchEffect.ToSoftObjectPath() };
+}
+
+bool AObstacle::AreEffectsLoaded() const
+{
+	return (ActivateSound.IsNull() || ActivateSound.IsValid())
+		&& (CascadeLaunchEffect.IsNull() || CascadeLaunchEffect.IsValid())
+		&& (NiagaraLaunchEffect.IsNull() || NiagaraLaunchEffect.IsValid());
+}
+
 void AObstacle::HandleBeginOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor,
 	UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::OverlapEvents);
+
+	// Grouped obstacles only follow the group clock, copies without authority the replicated state
+	if (bDrivenByGroup || !HasAuthority())
+	{
+		return;
+	}
+
 	if (bActivateOnObjectProximity)
 	{
-		Activate();
+		RequestActivation();
 	}
 	else if (bActivateOnPlayerProximity)
 	{
 		if (const ACharacter* Character = Cast<ACharacter>(OtherActor); Character && Character->IsPlayerControlled())
 		{
-			Activate();
+			RequestActivation();
 		}
 	}
 }
@@ -94,20 +399,72 @@ void AObstacle::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if (bActivateOnStart)
+	// Object proximity needs to see more than players
+	if (bActivateOnObjectProximity && Collider->GetCollisionProfileName() == LevelUpJamCollision::PlayerTriggerProfile)
+	{
+		Collider->SetCollisionProfileName(LevelUpJamCollision::ObjectTriggerProfile);
+	}
+
+	if (UObstacleEffectsSubsystem* Effects = GetWorld()->GetSubsystem<UObstacleEffectsSubsystem>())
+	{
+		Effects->AddInterest(this);
+	}
+
+	UDormancySubsystem* Dormancy = GetWorld()->GetSubsystem<UDormancySubsystem>();
+	if (Dormancy && HasAuthority())
+	{
+		Dormancy->RegisterActor(this);
+	}
+
+	UFixedStepSubsystem* FixedStepSubsystem = GetWorld()->GetSubsystem<UFixedStepSubsystem>();
+	if (FixedStepSubsystem && FixedStepSubsystem->IsEnabled())
+	{
+		bUseFixedStep = true;
+		FixedStepHandle = FixedStepSubsystem->OnFixedStep.AddUObject(this, &AObstacle::FixedStep);
+		PresentHandle = FixedStepSubsystem->OnPresent.AddUObject(this, &AObstacle::PresentFixedStep);
+	}
+
+	// The group may have taken over before this BeginPlay ran
+	if (bDrivenByGroup)
+	{
+		SetActorTickEnabled(false);
+	}
+	else if (bActivateOnStart)
 	{
 		if (AutoResetActivationDelay > 0.0f) // Reactivate after a delay > 0
 		{
-			GetWorldTimerManager().SetTimer(ActivationResetTimerHandle, this, &AObstacle::Activate, AutoResetActivationDelay, false);
+			StartLoopTimer(true, AutoResetActivationDelay);
 		}
 	}
 }
 
+void AObstacle::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UObstacleEffectsSubsystem* Effects = GetWorld()->GetSubsystem<UObstacleEffectsSubsystem>())
+	{
+		Effects->RemoveInterest(this);
+	}
+
+	if (UFixedStepSubsystem* FixedStepSubsystem = GetWorld()->GetSubsystem<UFixedStepSubsystem>())
+	{
+		FixedStepSubsystem->OnFixedStep.Remove(FixedStepHandle);
+		FixedStepSubsystem->OnPresent.Remove(PresentHandle);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 // Called every frame
 void AObstacle::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::ObstacleTicks);
+
+	if (!bUseFixedStep)
+	{
+		TickObstacle(DeltaTime);
+	}
 }
 
 void AObstacle::SetupAutoLoop()
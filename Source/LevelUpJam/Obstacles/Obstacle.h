@@ -2,13 +2,27 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "DormantActor.h"
 #include "Obstacle.generated.h"
 
+class AObstacle;
 class UBoxComponent;
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnActivatedDelegate);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnDeactivatedDelegate);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnInteractedDelegate);
 
+// Native counterparts of the Blueprint dispatchers, without reflection overhead
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnObstacleNativeEvent, AObstacle* /*Obstacle*/);
+
+// Events batched by UObstacleEventBus
+enum class EObstacleEvent : uint8
+{
+	Activated,
+	Deactivated
+};
+
+// Idle obstacles accept activation requests. After deactivating they stay in Cooldown for
+// CooldownDuration before going back to Idle; Disabled ones ignore requests until re-enabled.
 UENUM(BlueprintType)
 enum class EObstacleState : uint8
 {
@@ -18,8 +32,27 @@ enum class EObstacleState : uint8
 	Disabled
 };
 
+// What replicates of an obstacle. Movement is rebuilt from the state and its age rather than
+// replicating the transform, see LevelUpJamReplay.
+USTRUCT()
+struct FObstacleReplicatedState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	bool bActive = false;
+
+	// Movement progress when the state changed, from 0 at rest to 255 fully moved
+	UPROPERTY()
+	uint8 Progress = 0;
+
+	// LevelUpJamReplay::GetStateTime of the change
+	UPROPERTY()
+	float ChangeTime = 0.0f;
+};
+
 UCLASS()
-class LEVELUPJAM_API AObstacle : public AActor
+class LEVELUPJAM_API AObstacle : public AActor, public IDormantActor
 {
 	GENERATED_BODY()
 	
@@ -31,15 +64,24 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Obstacle|Events")
 	FOnDeactivatedDelegate OnDeactivated;
 
+	// C++ events, fired immediately alongside the Blueprint ones
+	FOnObstacleNativeEvent OnActivatedNative;
+	FOnObstacleNativeEvent OnDeactivatedNative;
+
+	/** Group used by UObstacleEventBus listeners, on top of the actor tags. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Obstacle|Events")
+	FName EventGroup;
+
+	// Effects are streamed in by UObstacleEffectsSubsystem while the obstacle is awake, not loaded with the map
 	// Sound to play when launch occurs
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Obstacle|Effects")
-	USoundBase* ActivateSound = nullptr;
+	TSoftObjectPtr<USoundBase> ActivateSound;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Obstacle|Effects")
-	UParticleSystem* CascadeLaunchEffect = nullptr;
+	TSoftObjectPtr<UParticleSystem> CascadeLaunchEffect;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Obstacle|Effects")
-	class UNiagaraSystem* NiagaraLaunchEffect = nullptr;
+	TSoftObjectPtr<class UNiagaraSystem> NiagaraLaunchEffect;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Obstacle|Effects")
 	bool bPlayEffectsOnActivate = true;
@@ -52,6 +94,12 @@ public:
 	/** Whether the obstacle auto-triggers activation on overlap with any object including. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Obstacle|Proximity")
 	bool bActivateOnObjectProximity = false;
+
+	/** Delay between a proximity overlap and the activation it requests. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Obstacle|Proximity")
+	float OverlapActivationDelay = 0.0f;
+
+	FTimerHandle OverlapActivationTimerHandle;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Obstacle|Timing|Auto")
 	bool bActivateOnStart = false;
@@ -73,6 +121,14 @@ public:
     float ReactionDelay = 0.0f;
     
     FTimerHandle ReactionTimerHandle;
+
+	/** Time after deactivating during which activation requests are ignored. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Obstacle|Timing")
+	float CooldownDuration = 0.0f;
+
+	/** Cooldown after an activation nothing deactivates (a pulse, e.g. a proximity launch pad), when CooldownDuration is shorter. Keeps new overlaps on later frames from re-triggering it right away. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Obstacle|Timing", meta = (ClampMin = "0.0"))
+	float PulseCooldownDuration = 0.5f;
 	
 	AObstacle();
 	
@@ -83,9 +139,29 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Obstacle")
 	virtual void Deactivate();
 
+	// Plays the effects once they are loaded, see UObstacleEffectsSubsystem::DeferEffects
 	UFUNCTION(BlueprintCallable, Category = "Obstacle|Effects")
 	virtual void PlayEffects();
 
+	// Spawns whichever effects are loaded right now, without deferring the others
+	void SpawnEffects();
+
+	struct FObstacleEffectPaths GetEffectPaths() const;
+	bool AreEffectsLoaded() const;
+
+	// Activates unless already active, cooling down, disabled or already requested this frame.
+	// Overlaps go through here so a pile of objects triggers the obstacle once. Obstacles that
+	// never deactivate on their own are only Active for the activation itself.
+	UFUNCTION(BlueprintCallable, Category = "Obstacle")
+	bool RequestActivation();
+
+	// Disabling stops the auto loop and rejects activation requests, enabling makes the obstacle Idle
+	UFUNCTION(BlueprintCallable, Category = "Obstacle")
+	void SetObstacleEnabled(bool bEnabled);
+
+	UFUNCTION(BlueprintPure, Category = "Obstacle")
+	EObstacleState GetObstacleState() const;
+
 	UFUNCTION()
 	virtual void HandleBeginOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor,
 									UPrimitiveComponent* OtherComp, int32 OtherBodyIndex,
@@ -103,8 +179,84 @@ protected:
 	TObjectPtr<UBoxComponent> Collider;
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
-	
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	void PostEvent(EObstacleEvent Event);
+
+	// Schedules the next step of the auto loop, on the timer manager or on the fixed step clock
+	void StartLoopTimer(bool bActivateNext, float Delay);
+
+	// Fixed step clock callbacks, see UFixedStepSubsystem
+	void FixedStep(float StepSeconds);
+	virtual void PresentFixedStep(float Alpha) {}
+
+	// Replication. The authority stamps every state change; other copies replay it through
+	// Activate/Deactivate, which do not start timers there, then catch the movement up.
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedState)
+	FObstacleReplicatedState ReplicatedState;
+
+	UFUNCTION()
+	void OnRep_ReplicatedState();
+
+	void UpdateReplicatedState(bool bActive);
+	float GetReplicatedStateAge() const;
+
+	// Quantized movement progress stored with a state change
+	virtual uint8 GetReplicatedProgress() const { return 0; }
+
+	// Moves to where the authority is, StateAge seconds after the replicated state change
+	virtual void RestoreReplicatedState(float StateAge) {}
+
+public:
 	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Obstacle")
 	virtual void SetupAutoLoop();
+
+	UBoxComponent* GetCollider() const { return Collider; }
+
+	// Hands the activation loop and movement over to an AObstacleGroup: own timers and tick stop
+	void SetDrivenByGroup(bool bDriven);
+	bool IsDrivenByGroup() const { return bDrivenByGroup; }
+
+	// Per-frame obstacle logic, called from Tick or by the owning group. Override this rather than Tick.
+	virtual void TickObstacle(float DeltaTime) {}
+
+	// Jumps to the end of the current movement
+	virtual void SnapMovement() {}
+
+	/** Distance to the nearest player beyond which the obstacle goes dormant, 0 for the project default. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Obstacle|Dormancy")
+	float DormancyDistance = 0.0f;
+
+	// IDormantActor
+	virtual float GetDormancyDistance() const override { return DormancyDistance; }
+	virtual bool CanEnterDormancy() const override { return !bDrivenByGroup; }
+	virtual void EnterDormancy() override;
+	virtual void ExitDormancy(float DormantSeconds) override;
+
+	// Whether TickObstacle runs on the fixed step clock instead of the frame time
+	bool IsUsingFixedStep() const { return bUseFixedStep; }
+
+private:
+	// Leaves Active for Cooldown, or Idle without a cooldown
+	void StartCooldown(float Duration);
+
+	EObstacleState State = EObstacleState::Idle;
+
+	// World time the cooldown ends, the state is left lazily when it is next read
+	double CooldownEndTime = 0.0;
+
+	// GFrameCounter of the last accepted activation request
+	uint64 LastRequestFrame = MAX_uint64;
+
+	bool bDrivenByGroup = false;
+
+	bool bUseFixedStep = false;
+	FDelegateHandle FixedStepHandle;
+	FDelegateHandle PresentHandle;
+
+	// Auto loop countdown used instead of timers on the fixed step clock, below 0 when idle
+	float FixedLoopRemaining = -1.0f;
+	bool bFixedLoopActivates = false;
 };
\ No newline at end of file
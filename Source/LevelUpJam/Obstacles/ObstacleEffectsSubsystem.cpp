@@ -0,0 +1,192 @@
+#include "ObstacleEffectsSubsystem.h"
+
+#include "Obstacle.h"
+#include "LevelUpJam.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Obstacle Effect Sets Loaded"), STAT_ObstacleEffectSetsLoaded, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Obstacle Effects Played Late"), STAT_ObstacleEffectsLate, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Obstacle Effects Dropped"), STAT_ObstacleEffectsDropped, STATGROUP_LevelUpJam);
+
+bool UObstacleEffectsSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	// Nothing is heard or seen on a dedicated server
+	return !IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UObstacleEffectsSubsystem::Deinitialize()
+{
+	for (TPair<FObstacleEffectPaths, FEffectSet>& Pair : Sets)
+	{
+		if (Pair.Value.Handle.IsValid())
+		{
+			Pair.Value.Handle->CancelHandle();
+		}
+	}
+	Sets.Reset();
+	Interested.Reset();
+	FailedPaths.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId UObstacleEffectsSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UObstacleEffectsSubsystem, STATGROUP_Tickables);
+}
+
+void UObstacleEffectsSubsystem::AddInterest(AObstacle* Obstacle)
+{
+	const FObstacleEffectPaths Paths = Obstacle->GetEffectPaths();
+	if (Paths.IsEmpty() || Interested.Contains(Obstacle))
+	{
+		return;
+	}
+
+	Interested.Add(Obstacle, Paths);
+
+	FEffectSet& Set = Sets.FindOrAdd(Paths);
+	++Set.NumInterested;
+	Set.IdleSince = -1.0;
+	if (!Set.Handle.IsValid())
+	{
+		RequestLoad(Paths, Set, false);
+	}
+}
+
+void UObstacleEffectsSubsystem::RemoveInterest(AObstacle* Obstacle)
+{
+	FObstacleEffectPaths Paths;
+	if (!Interested.RemoveAndCopyValue(Obstacle, Paths))
+	{
+		return;
+	}
+
+	if (FEffectSet* Set = Sets.Find(Paths); Set && --Set->NumInterested == 0)
+	{
+		Set->IdleSince = GetWorld()->GetTimeSeconds();
+	}
+}
+
+void UObstacleEffectsSubsystem::DeferEffects(AObstacle* Obstacle)
+{
+	const FObstacleEffectPaths Paths = Obstacle->GetEffectPaths();
+	if (Paths.IsEmpty())
+	{
+		return;
+	}
+
+	FEffectSet& Set = Sets.FindOrAdd(Paths);
+
+	// The load already finished and some of the assets failed, play what there is
+	if (Set.Handle.IsValid() && Set.Handle->HasLoadCompleted())
+	{
+		Obstacle->SpawnEffects();
+		return;
+	}
+
+	Set.Deferred.Emplace(Obstacle, GetWorld()->GetTimeSeconds());
+
+	// Activated without being relevant first, or still loading in the background: hurry it up
+	if (!Set.Handle.IsValid())
+	{
+		Set.IdleSince = Set.NumInterested > 0 ? -1.0 : GetWorld()->GetTimeSeconds();
+		RequestLoad(Paths, Set, true);
+	}
+}
+
+int32 UObstacleEffectsSubsystem::GetNumLoadedSets() const
+{
+	int32 NumLoaded = 0;
+	for (const TPair<FObstacleEffectPaths, FEffectSet>& Pair : Sets)
+	{
+		NumLoaded += Pair.Value.Handle.IsValid() && Pair.Value.Handle->HasLoadCompleted();
+	}
+	return NumLoaded;
+}
+
+void UObstacleEffectsSubsystem::RequestLoad(const FObstacleEffectPaths& Paths, FEffectSet& Set, bool bHighPriority)
+{
+	TArray<FSoftObjectPath, TInlineAllocator<3>> Assets;
+	for (const FSoftObjectPath& Path : { Paths.Sound, Paths.CascadeEffect, Paths.NiagaraEffect })
+	{
+		if (!Path.IsNull())
+		{
+			Assets.Add(Path);
+		}
+	}
+
+	Set.Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(TArray<FSoftObjectPath>(Assets),
+		FStreamableDelegate::CreateUObject(this, &UObstacleEffectsSubsystem::OnSetLoaded, Paths),
+		bHighPriority ? FStreamableManager::AsyncLoadHighPriority : FStreamableManager::DefaultAsyncLoadPriority);
+}
+
+void UObstacleEffectsSubsystem::OnSetLoaded(FObstacleEffectPaths Paths)
+{
+	FEffectSet* Set = Sets.Find(Paths);
+	if (!Set)
+	{
+		return;
+	}
+
+	for (const FSoftObjectPath& Path : { Paths.Sound, Paths.CascadeEffect, Paths.NiagaraEffect })
+	{
+		bool bAlreadyLogged = false;
+		if (!Path.IsNull() && !Path.ResolveObject())
+		{
+			FailedPaths.Add(Path, &bAlreadyLogged);
+			UE_CLOG(!bAlreadyLogged, LogLevelUpJam, Warning, TEXT("ObstacleEffects: '%s' could not be loaded, obstacles using it play their other effects only."), *Path.ToString());
+		}
+	}
+
+	// Moved out first so nothing playing the effects can add to the array being iterated
+	const TArray<TPair<TWeakObjectPtr<AObstacle>, double>> DeferredEffects = MoveTemp(Set->Deferred);
+	Set->Deferred.Reset();
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	for (const TPair<TWeakObjectPtr<AObstacle>, double>& Deferred : DeferredEffects)
+	{
+		AObstacle* Obstacle = Deferred.Key.Get();
+		if (!Obstacle)
+		{
+			continue;
+		}
+
+		if (Now - Deferred.Value <= MaxDeferredEffectAge)
+		{
+			Obstacle->SpawnEffects();
+			INC_DWORD_STAT(STAT_ObstacleEffectsLate);
+		}
+		else
+		{
+			UE_LOG(LogLevelUpJam, Verbose, TEXT("ObstacleEffects: dropped effects of '%s', loaded %.2fs after they were played."),
+				*Obstacle->GetName(), Now - Deferred.Value);
+			INC_DWORD_STAT(STAT_ObstacleEffectsDropped);
+		}
+	}
+}
+
+void UObstacleEffectsSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Release sets nobody needed for a while, garbage collection unloads the assets
+	const double Now = GetWorld()->GetTimeSeconds();
+	for (auto It = Sets.CreateIterator(); It; ++It)
+	{
+		FEffectSet& Set = It.Value();
+		if (Set.NumInterested == 0 && Set.Deferred.IsEmpty() && Set.IdleSince >= 0.0 && Now - Set.IdleSince >= ReleaseDelay)
+		{
+			if (Set.Handle.IsValid())
+			{
+				Set.Handle->ReleaseHandle();
+			}
+			It.RemoveCurrent();
+		}
+	}
+
+	SET_DWORD_STAT(STAT_ObstacleEffectSetsLoaded, GetNumLoadedSets());
+	CSV_CUSTOM_STAT(LevelUpJam, ObstacleEffectSetsLoaded, GetNumLoadedSets(), ECsvCustomStatOp::Set);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ObstacleEffectsSubsystem.generated.h"
+
+class AObstacle;
+struct FStreamableHandle;
+
+// The effect assets of an obstacle. Obstacles with the same set share one load.
+struct FObstacleEffectPaths
+{
+	FSoftObjectPath Sound;
+	FSoftObjectPath CascadeEffect;
+	FSoftObjectPath NiagaraEffect;
+
+	bool IsEmpty() const { return Sound.IsNull() && CascadeEffect.IsNull() && NiagaraEffect.IsNull(); }
+
+	bool operator==(const FObstacleEffectPaths& Other) const
+	{
+		return Sound == Other.Sound && CascadeEffect == Other.CascadeEffect && NiagaraEffect == Other.NiagaraEffect;
+	}
+
+	friend uint32 GetTypeHash(const FObstacleEffectPaths& Paths)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Paths.Sound), GetTypeHash(Paths.CascadeEffect)), GetTypeHash(Paths.NiagaraEffect));
+	}
+};
+
+/**
+ * Streams obstacle effects (sounds, particles) asynchronously instead of loading them with the
+ * map. Obstacles register interest while they are relevant, which is while they are awake; the
+ * effects of a set are loaded while any obstacle using it is interested and released a while
+ * after the last one lost interest. Effects played before their load finished are played late
+ * once it does, or dropped if that took too long.
+ */
+UCLASS(Config = Game)
+class LEVELUPJAM_API UObstacleEffectsSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void AddInterest(AObstacle* Obstacle);
+	void RemoveInterest(AObstacle* Obstacle);
+
+	// Called when the obstacle wants to play effects that are not loaded yet
+	void DeferEffects(AObstacle* Obstacle);
+
+	UFUNCTION(BlueprintPure, Category = "Obstacle|Effects")
+	int32 GetNumLoadedSets() const;
+
+protected:
+	/** Seconds effects stay loaded after no obstacle using them is relevant anymore. */
+	UPROPERTY(Config)
+	float ReleaseDelay = 10.0f;
+
+	/** Effects whose load took longer than this after they were played are dropped. */
+	UPROPERTY(Config)
+	float MaxDeferredEffectAge = 0.5f;
+
+private:
+	struct FEffectSet
+	{
+		TSharedPtr<FStreamableHandle> Handle;
+		int32 NumInterested = 0;
+		double IdleSince = -1.0;
+
+		// Obstacles that played the effects before they were loaded, and when
+		TArray<TPair<TWeakObjectPtr<AObstacle>, double>> Deferred;
+	};
+
+	void RequestLoad(const FObstacleEffectPaths& Paths, FEffectSet& Set, bool bHighPriority);
+	void OnSetLoaded(FObstacleEffectPaths Paths);
+
+	TMap<FObstacleEffectPaths, FEffectSet> Sets;
+	TMap<TWeakObjectPtr<AObstacle>, FObstacleEffectPaths> Interested;
+
+	// Assets that failed to load, warned about once
+	TSet<FSoftObjectPath> FailedPaths;
+};
@@ -0,0 +1,122 @@
+#include "ObstacleEventBus.h"
+
+void UObstacleEventBus::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingEvents.IsEmpty())
+	{
+		return;
+	}
+
+	// Listeners may activate obstacles, those events go to the next frame's batch
+	Swap(PendingEvents, DispatchingEvents);
+
+	OnAnyEvents.Broadcast(DispatchingEvents);
+
+	if (!TagListeners.IsEmpty())
+	{
+		DispatchKeyed(TagListeners, [](const AObstacle& Obstacle, TArray<FName, TInlineAllocator<4>>& OutKeys)
+		{
+			OutKeys.Append(Obstacle.Tags);
+		});
+	}
+
+	if (!GroupListeners.IsEmpty())
+	{
+		DispatchKeyed(GroupListeners, [](const AObstacle& Obstacle, TArray<FName, TInlineAllocator<4>>& OutKeys)
+		{
+			if (!Obstacle.EventGroup.IsNone())
+			{
+				OutKeys.Add(Obstacle.EventGroup);
+			}
+		});
+	}
+
+	DispatchingEvents.Reset();
+}
+
+TStatId UObstacleEventBus::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UObstacleEventBus, STATGROUP_Tickables);
+}
+
+void UObstacleEventBus::Post(AObstacle* Obstacle, EObstacleEvent Type)
+{
+	// Nobody would receive the batch, skip collecting it
+	if (!HasListeners())
+	{
+		return;
+	}
+
+	PendingEvents.Add({ Obstacle, Type });
+}
+
+bool UObstacleEventBus::HasListeners() const
+{
+	if (OnAnyEvents.IsBound())
+	{
+		return true;
+	}
+
+	for (const TPair<FName, FOnObstacleEventBatch>& Pair : TagListeners)
+	{
+		if (Pair.Value.IsBound())
+		{
+			return true;
+		}
+	}
+
+	for (const TPair<FName, FOnObstacleEventBatch>& Pair : GroupListeners)
+	{
+		if (Pair.Value.IsBound())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void UObstacleEventBus::DispatchKeyed(const TMap<FName, FOnObstacleEventBatch>& Listeners, TFunctionRef<void(const AObstacle&, TArray<FName, TInlineAllocator<4>>&)> GetKeys)
+{
+	for (TPair<FName, TArray<FObstacleEvent>>& Pair : KeyedEvents)
+	{
+		Pair.Value.Reset();
+	}
+
+	TArray<FName, TInlineAllocator<4>> Keys;
+	for (const FObstacleEvent& Event : DispatchingEvents)
+	{
+		const AObstacle* Obstacle = Event.Obstacle.Get();
+		if (!Obstacle)
+		{
+			continue;
+		}
+
+		Keys.Reset();
+		GetKeys(*Obstacle, Keys);
+		for (const FName Key : Keys)
+		{
+			const FOnObstacleEventBatch* Listener = Listeners.Find(Key);
+			if (Listener && Listener->IsBound())
+			{
+				KeyedEvents.FindOrAdd(Key).Add(Event);
+			}
+		}
+	}
+
+	for (const TPair<FName, TArray<FObstacleEvent>>& Pair : KeyedEvents)
+	{
+		if (Pair.Value.IsEmpty())
+		{
+			continue;
+		}
+
+		// Copied so listeners can bind new keys while being notified
+		if (const FOnObstacleEventBatch* Listener = Listeners.Find(Pair.Key))
+		{
+			const FOnObstacleEventBatch ListenerCopy = *Listener;
+			ListenerCopy.Broadcast(Pair.Value);
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Obstacle.h"
+#include "ObstacleEventBus.generated.h"
+
+struct FObstacleEvent
+{
+	TWeakObjectPtr<AObstacle> Obstacle;
+	EObstacleEvent Type = EObstacleEvent::Activated;
+};
+
+// Receives every event of one frame matching the key it was bound to
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnObstacleEventBatch, TConstArrayView<FObstacleEvent> /*Events*/);
+
+/**
+ * Collects obstacle activations and deactivations during the frame and hands them to C++
+ * listeners (audio, drones, counters) in one call per key. Listeners bind to an actor tag or an
+ * obstacle EventGroup instead of to every obstacle. Nothing is collected while no listener is
+ * bound; the benchmark counts the events through OnAnyEvents.
+ */
+UCLASS()
+class LEVELUPJAM_API UObstacleEventBus : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Queues the event for the end of the frame, dropped right away when nothing listens
+	void Post(AObstacle* Obstacle, EObstacleEvent Type);
+
+	bool HasListeners() const;
+
+	// Events from obstacles with the actor tag
+	FOnObstacleEventBatch& OnTag(FName Tag) { return TagListeners.FindOrAdd(Tag); }
+
+	// Events from obstacles with the EventGroup
+	FOnObstacleEventBatch& OnGroup(FName Group) { return GroupListeners.FindOrAdd(Group); }
+
+	// Every event of the frame
+	FOnObstacleEventBatch OnAnyEvents;
+
+private:
+	void DispatchKeyed(const TMap<FName, FOnObstacleEventBatch>& Listeners, TFunctionRef<void(const AObstacle&, TArray<FName, TInlineAllocator<4>>&)> GetKeys);
+
+	TMap<FName, FOnObstacleEventBatch> TagListeners;
+	TMap<FName, FOnObstacleEventBatch> GroupListeners;
+
+	TArray<FObstacleEvent> PendingEvents;
+	TArray<FObstacleEvent> DispatchingEvents;
+
+	// Per-key scratch lists, reused between frames
+	TMap<FName, TArray<FObstacleEvent>> KeyedEvents;
+};
@@ -0,0 +1,201 @@
+#include "ObstacleGroup.h"
+
+#include "Obstacle.h"
+#include "FixedStepSubsystem.h"
+#include "LevelUpJam.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+AObstacleGroup::AObstacleGroup()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	// Replicated only so clients get a non-authoritative copy, the group itself sends nothing
+	bReplicates = true;
+	SetReplicatingMovement(false);
+	NetDormancy = DORM_Initial;
+}
+
+void AObstacleGroup::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Clients and replays have the members follow their replicated state
+	if (!HasAuthority() || GetWorld()->IsPlayingReplay())
+	{
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	for (FObstacleGroupMember& Member : Members)
+	{
+		if (Member.Obstacle)
+		{
+			Member.Obstacle->SetDrivenByGroup(true);
+		}
+		Member.bActive = false;
+	}
+
+	bInRange = ActiveRange <= 0.0f || IsAnyPlayerInRange();
+
+	UFixedStepSubsystem* FixedStepSubsystem = GetWorld()->GetSubsystem<UFixedStepSubsystem>();
+	if (FixedStepSubsystem && FixedStepSubsystem->IsEnabled())
+	{
+		bUseFixedStep = true;
+		FixedStepHandle = FixedStepSubsystem->OnFixedStep.AddUObject(this, &AObstacleGroup::StepGroup);
+	}
+}
+
+void AObstacleGroup::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Members that outlive the group get their own loop back
+	for (FObstacleGroupMember& Member : Members)
+	{
+		if (IsValid(Member.Obstacle))
+		{
+			Member.Obstacle->SetDrivenByGroup(false);
+		}
+	}
+
+	if (UFixedStepSubsystem* FixedStepSubsystem = GetWorld()->GetSubsystem<UFixedStepSubsystem>())
+	{
+		FixedStepSubsystem->OnFixedStep.Remove(FixedStepHandle);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AObstacleGroup::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::ObstacleTicks);
+
+	TimeSinceRangeCheck += DeltaTime;
+	if (ActiveRange > 0.0f && TimeSinceRangeCheck >= RangeCheckInterval)
+	{
+		TimeSinceRangeCheck = 0.0f;
+
+		const bool bWasInRange = bInRange;
+		bInRange = IsAnyPlayerInRange();
+		if (bInRange && !bWasInRange && OutOfRangeBehavior == EObstacleGroupOutOfRange::Skip)
+		{
+			SnapToPhase();
+		}
+	}
+
+	if (!bUseFixedStep)
+	{
+		StepGroup(DeltaTime);
+	}
+}
+
+void AObstacleGroup::StepGroup(float DeltaTime)
+{
+	if (bPaused)
+	{
+		return;
+	}
+
+	if (!bInRange && OutOfRangeBehavior != EObstacleGroupOutOfRange::None)
+	{
+		if (OutOfRangeBehavior == EObstacleGroupOutOfRange::Skip)
+		{
+			Clock += DeltaTime;
+		}
+		return;
+	}
+
+	Clock += DeltaTime;
+
+	// Collect the transitions first so the whole row switches in one batch
+	TArray<AObstacle*, TInlineAllocator<16>> ToActivate;
+	TArray<AObstacle*, TInlineAllocator<16>> ToDeactivate;
+	for (int32 Index = 0; Index < Members.Num(); ++Index)
+	{
+		FObstacleGroupMember& Member = Members[Index];
+		if (!IsValid(Member.Obstacle))
+		{
+			continue;
+		}
+
+		const bool bShouldBeActive = IsMemberActiveAt(Index, Clock);
+		if (bShouldBeActive != Member.bActive)
+		{
+			Member.bActive = bShouldBeActive;
+			(bShouldBeActive ? ToActivate : ToDeactivate).Add(Member.Obstacle);
+		}
+	}
+
+	for (AObstacle* Obstacle : ToActivate)
+	{
+		Obstacle->Activate();
+	}
+	for (AObstacle* Obstacle : ToDeactivate)
+	{
+		Obstacle->Deactivate();
+	}
+
+	for (const FObstacleGroupMember& Member : Members)
+	{
+		if (IsValid(Member.Obstacle))
+		{
+			Member.Obstacle->TickObstacle(DeltaTime);
+		}
+	}
+}
+
+void AObstacleGroup::SetPaused(bool bNewPaused)
+{
+	bPaused = bNewPaused;
+}
+
+bool AObstacleGroup::IsMemberActiveAt(int32 MemberIndex, float Time) const
+{
+	if (CycleDuration <= 0.0f)
+	{
+		return false;
+	}
+
+	const float MemberTime = Time - Members[MemberIndex].PhaseOffset - MemberIndex * MemberPhaseStep;
+	return MemberTime >= 0.0f && FMath::Fmod(MemberTime, CycleDuration) < ActiveDuration;
+}
+
+bool AObstacleGroup::IsAnyPlayerInRange() const
+{
+	const FVector Location = GetActorLocation();
+	const float RangeSquared = FMath::Square(ActiveRange);
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr;
+		if (Pawn && FVector::DistSquared(Pawn->GetActorLocation(), Location) <= RangeSquared)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void AObstacleGroup::SnapToPhase()
+{
+	for (int32 Index = 0; Index < Members.Num(); ++Index)
+	{
+		FObstacleGroupMember& Member = Members[Index];
+		if (!IsValid(Member.Obstacle))
+		{
+			continue;
+		}
+
+		const bool bShouldBeActive = IsMemberActiveAt(Index, Clock);
+		if (bShouldBeActive != Member.bActive)
+		{
+			Member.bActive = bShouldBeActive;
+			bShouldBeActive ? Member.Obstacle->Activate() : Member.Obstacle->Deactivate();
+		}
+		Member.Obstacle->SnapMovement();
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ObstacleGroup.generated.h"
+
+class AObstacle;
+
+USTRUCT(BlueprintType)
+struct FObstacleGroupMember
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ObstacleGroup")
+	TObjectPtr<AObstacle> Obstacle;
+
+	/** Seconds this member lags behind the group clock, on top of the group's MemberPhaseStep. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ObstacleGroup")
+	float PhaseOffset = 0.0f;
+
+	// Whether the member was last activated by the group
+	bool bActive = false;
+};
+
+UENUM(BlueprintType)
+enum class EObstacleGroupOutOfRange : uint8
+{
+	// Keep running as if the player were close
+	None,
+	// Stop the group clock, the row resumes where it was
+	Pause,
+	// Keep the clock running but do nothing, the row snaps to the current phase when back in range
+	Skip
+};
+
+/**
+ * Drives a row of obstacles (pistons, doors, arms) from one shared clock. Members lose their own
+ * timers and tick: the group activates and deactivates them in lock-step, each shifted by its
+ * phase offset, and moves them from its single tick.
+ */
+UCLASS()
+class LEVELUPJAM_API AObstacleGroup : public AActor
+{
+	GENERATED_BODY()
+	
+public:
+	AObstacleGroup();
+
+	/** Obstacles of the group, in sequence order. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ObstacleGroup")
+	TArray<FObstacleGroupMember> Members;
+
+	/** Length of one activate/deactivate cycle in seconds. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ObstacleGroup")
+	float CycleDuration = 2.0f;
+
+	/** Part of the cycle, in seconds, during which a member is active. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ObstacleGroup")
+	float ActiveDuration = 1.0f;
+
+	/** Extra phase offset per member index, to make a wave along the row. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ObstacleGroup")
+	float MemberPhaseStep = 0.0f;
+
+	/** Players further than this from the group put it out of range, 0 to disable. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ObstacleGroup|Range")
+	float ActiveRange = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ObstacleGroup|Range")
+	EObstacleGroupOutOfRange OutOfRangeBehavior = EObstacleGroupOutOfRange::Pause;
+
+	/** Seconds between two player range checks. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ObstacleGroup|Range")
+	float RangeCheckInterval = 0.5f;
+
+	UFUNCTION(BlueprintCallable, Category = "ObstacleGroup")
+	void SetPaused(bool bNewPaused);
+
+	UFUNCTION(BlueprintPure, Category = "ObstacleGroup")
+	bool IsPaused() const { return bPaused; }
+
+	UFUNCTION(BlueprintPure, Category = "ObstacleGroup")
+	bool IsInRange() const { return bInRange; }
+
+	UFUNCTION(BlueprintPure, Category = "ObstacleGroup")
+	float GetClock() const { return Clock; }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaTime) override;
+
+	bool IsMemberActiveAt(int32 MemberIndex, float Time) const;
+	bool IsAnyPlayerInRange() const;
+
+	// Advances the clock and the members, from Tick or from the fixed step clock
+	void StepGroup(float DeltaTime);
+
+	// Applies the phase of the current clock to every member without any transition
+	void SnapToPhase();
+
+	float Clock = 0.0f;
+	float TimeSinceRangeCheck = 0.0f;
+	bool bPaused = false;
+	bool bInRange = true;
+	bool bUseFixedStep = false;
+	FDelegateHandle FixedStepHandle;
+};
@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BakedGridFile.h"
+#include "LevelUpJam.h"
+#include "Async/MappedFileHandle.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+
+FBakedGridFile::FBakedGridFile() = default;
+
+FBakedGridFile::~FBakedGridFile()
+{
+	Close();
+}
+
+FString FBakedGridFile::GetBakedDataDir()
+{
+	return FPaths::ProjectContentDir() / TEXT("BakedData");
+}
+
+FString FBakedGridFile::GetDefaultFileName(const AActor* Actor)
+{
+	// World Partition loads actors into generated cell levels, only the map itself is stable
+	const UWorld* World = Actor->GetWorld();
+	const UPackage* Package = World && World->IsPartitionedWorld() ? World->GetPackage() : Actor->GetLevel()->GetPackage();
+	const FString MapName = FPackageName::GetShortName(UWorld::RemovePIEPrefix(Package->GetName()));
+
+	return FString::Printf(TEXT("%s_%s"), *MapName, *Actor->GetName());
+}
+
+bool FBakedGridFile::Write(const FString& Path, const FBakedGridHeader& InHeader, TConstArrayView<uint8> InPayload)
+{
+	TArray<uint8> Buffer;
+	Buffer.Reserve(sizeof(FBakedGridHeader) + InPayload.Num());
+	Buffer.Append(reinterpret_cast<const uint8*>(&InHeader), sizeof(FBakedGridHeader));
+	Buffer.Append(InPayload.GetData(), InPayload.Num());
+
+	return FFileHelper::SaveArrayToFile(Buffer, *Path);
+}
+
+bool FBakedGridFile::Open(const FString& Path, uint32 ExpectedMagic, uint32 ExpectedVersion)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	FOpenMappedResult Result = PlatformFile.OpenMappedEx(*Path);
+	if (Result.HasError())
+	{
+		UE_LOG(LogLevelUpJam, Warning, TEXT("Baked grid '%s' could not be mapped."), *Path);
+		return false;
+	}
+
+	MappedFile = Result.StealValue();
+	const int64 FileSize = MappedFile->GetFileSize();
+	if (FileSize < static_cast<int64>(sizeof(FBakedGridHeader)))
+	{
+		Close();
+		return false;
+	}
+
+	MappedRegion.Reset(MappedFile->MapRegion(0, FileSize));
+	if (!MappedRegion)
+	{
+		Close();
+		return false;
+	}
+
+	FMemory::Memcpy(&Header, MappedRegion->GetMappedPtr(), sizeof(FBakedGridHeader));
+
+	const int64 NumCells = static_cast<int64>(Header.Dimensions.X) * Header.Dimensions.Y * Header.Dimensions.Z;
+	const bool bValid = Header.Magic == ExpectedMagic
+		&& Header.Version == ExpectedVersion
+		&& Header.CellSize > 0.0f
+		&& NumCells > 0
+		&& Header.PayloadSize == static_cast<uint64>(NumCells * Header.BytesPerCell)
+		&& FileSize >= static_cast<int64>(sizeof(FBakedGridHeader) + Header.PayloadSize);
+
+	if (!bValid)
+	{
+		UE_LOG(LogLevelUpJam, Warning, TEXT("Baked grid '%s' is out of date or corrupt, rebake it."), *Path);
+		Close();
+		return false;
+	}
+
+	Payload = MappedRegion->GetMappedPtr() + sizeof(FBakedGridHeader);
+	return true;
+}
+
+void FBakedGridFile::Close()
+{
+	Payload = nullptr;
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	Header = FBakedGridHeader();
+}
+
+bool FBakedGridFile::WorldToCell(const FVector& Location, FIntVector& OutCell) const
+{
+	const FVector Local = (Location - FVector(Header.Origin)) / Header.CellSize;
+	OutCell = FIntVector(FMath::FloorToInt32(Local.X), FMath::FloorToInt32(Local.Y), FMath::FloorToInt32(Local.Z));
+	return IsValidCell(OutCell);
+}
+
+FVector FBakedGridFile::CellToWorld(const FIntVector& Cell) const
+{
+	return FVector(Header.Origin) + (FVector(Cell) + FVector(0.5)) * Header.CellSize;
+}
+
+int32 FBakedGridFile::CellToIndex(const FIntVector& Cell) const
+{
+	return (Cell.Z * Header.Dimensions.Y + Cell.Y) * Header.Dimensions.X + Cell.X;
+}
+
+bool FBakedGridFile::IsValidCell(const FIntVector& Cell) const
+{
+	return Cell.X >= 0 && Cell.Y >= 0 && Cell.Z >= 0
+		&& Cell.X < Header.Dimensions.X && Cell.Y < Header.Dimensions.Y && Cell.Z < Header.Dimensions.Z;
+}
+
+const uint8* FBakedGridFile::GetCellData(const FIntVector& Cell) const
+{
+	if (!Payload || !IsValidCell(Cell))
+	{
+		return nullptr;
+	}
+	return Payload + static_cast<int64>(CellToIndex(Cell)) * Header.BytesPerCell;
+}
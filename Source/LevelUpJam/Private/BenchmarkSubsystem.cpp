@@ -0,0 +1,491 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BenchmarkSubsystem.h"
+#include "BoxCharacter.h"
+#include "Drone.h"
+#include "FixedStepSubsystem.h"
+#include "Obstacles/MovingObstacle.h"
+#include "Obstacles/ObstacleEventBus.h"
+#include "Dom/JsonObject.h"
+#include "Engine/TargetPoint.h"
+#include "Engine/World.h"
+#include "Engine/GameInstance.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace BenchmarkInput
+{
+	constexpr float MinStepDuration = 1.0f / 60.0f;
+}
+
+bool UBenchmarkSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("LUJBenchmark"));
+}
+
+void UBenchmarkSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+
+	FString MapList;
+	if (FParse::Value(CommandLine, TEXT("BenchmarkMaps="), MapList))
+	{
+		TArray<FString> ShortNames;
+		MapList.ParseIntoArray(ShortNames, TEXT("+"));
+
+		// Short names select from the configured maps, anything else is used as a package name
+		TArray<FString> Selected;
+		for (const FString& Name : ShortNames)
+		{
+			const FString* Match = Maps.FindByPredicate([&Name](const FString& Map)
+			{
+				return FPackageName::GetShortName(Map) == Name;
+			});
+			Selected.Add(Match ? *Match : Name);
+		}
+		Maps = MoveTemp(Selected);
+	}
+
+	FParse::Value(CommandLine, TEXT("BenchmarkSeconds="), MeasureSeconds);
+	FParse::Value(CommandLine, TEXT("BenchmarkDrones="), NumDrones);
+	FParse::Value(CommandLine, TEXT("BenchmarkObstacles="), NumObstacles);
+	FParse::Value(CommandLine, TEXT("BenchmarkTolerance="), RegressionTolerance);
+	FParse::Value(CommandLine, TEXT("BenchmarkBaseline="), BaselinePath);
+	bRecordReplay = FParse::Param(CommandLine, TEXT("BenchmarkReplay"));
+
+	// A recorded session drives the character instead of the scripted path
+	FString ReplayName;
+	if (FParse::Value(CommandLine, TEXT("ReplayInput="), ReplayName))
+	{
+		InputPath.Empty();
+	}
+
+	OutputDir = FPaths::ProjectSavedDir() / TEXT("Benchmark");
+	FParse::Value(CommandLine, TEXT("BenchmarkOutput="), OutputDir);
+
+	if (Maps.IsEmpty())
+	{
+		UE_LOG(LogLevelUpJam, Error, TEXT("Benchmark: no maps configured."));
+		return;
+	}
+
+	for (int32 Counter = 0; Counter < static_cast<int32>(LevelUpJamCounters::ECounter::Num); ++Counter)
+	{
+		CounterStatNames.Add(FName(LevelUpJamCounters::GetName(static_cast<LevelUpJamCounters::ECounter>(Counter))));
+	}
+
+	bRunning = true;
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UBenchmarkSubsystem::OnPostLoadMap);
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UBenchmarkSubsystem::Tick));
+}
+
+void UBenchmarkSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+	Super::Deinitialize();
+}
+
+void UBenchmarkSubsystem::OnPostLoadMap(UWorld* World)
+{
+	if (!bRunning || !World || !World->IsGameWorld())
+	{
+		return;
+	}
+
+	// The first map loaded is whatever the engine starts with; switch to the benchmark list from there
+	if (CurrentMapIndex == INDEX_NONE)
+	{
+		CurrentMapIndex = 0;
+	}
+
+	if (World->GetOutermost()->GetName() != Maps[CurrentMapIndex])
+	{
+		// A different map after we opened one means the open failed and the engine fell back to
+		// its default map. Opening it again would loop forever, skip it instead.
+		if (OpenMapTime >= 0.0)
+		{
+			UE_LOG(LogLevelUpJam, Error, TEXT("Benchmark: could not load %s, skipping it"), *Maps[CurrentMapIndex]);
+			OpenMapTime = -1.0;
+
+			FMapResult& Result = Results.AddDefaulted_GetRef();
+			Result.Map = Maps[CurrentMapIndex];
+			Result.bLoadFailed = true;
+
+			OpenNextMap();
+			return;
+		}
+
+		OpenMap(CurrentMapIndex);
+		return;
+	}
+
+	StartMap(World);
+}
+
+void UBenchmarkSubsystem::OpenMap(int32 MapIndex)
+{
+	UE_LOG(LogLevelUpJam, Display, TEXT("Benchmark: opening %s"), *Maps[MapIndex]);
+	OpenMapTime = FPlatformTime::Seconds();
+	UGameplayStatics::OpenLevel(GetGameInstance(), FName(*Maps[MapIndex]));
+}
+
+void UBenchmarkSubsystem::OpenNextMap()
+{
+	OpenNextMap();
+}
+
+void UBenchmarkSubsystem::StartMap(UWorld* World)
+{
+	CurrentWorld = World;
+	MapElapsed = 0.0f;
+	InputElapsed = 0.0f;
+	InputStep = 0;
+	bMeasuring = false;
+
+	FMapResult& Result = Results.AddDefaulted_GetRef();
+	Result.Map = Maps[CurrentMapIndex];
+
+	// The engine's startup map was not opened by us, its load time counts from process start
+	Result.LoadSeconds = FPlatformTime::Seconds() - (OpenMapTime >= 0.0 ? OpenMapTime : GStartTime);
+	Result.UsedPhysicalAfterLoad = FPlatformMemory::GetStats().UsedPhysical;
+	OpenMapTime = -1.0;
+
+	// Obstacle events are counted from the bus, the same batches audio and drones would receive
+	if (UObstacleEventBus* EventBus = World->GetSubsystem<UObstacleEventBus>())
+	{
+		EventBus->OnAnyEvents.AddUObject(this, &UBenchmarkSubsystem::OnObstacleEvents);
+	}
+
+	SpawnActors(World);
+}
+
+void UBenchmarkSubsystem::OnObstacleEvents(TConstArrayView<FObstacleEvent> Events)
+{
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::ObstacleEvents, Events.Num());
+}
+
+void UBenchmarkSubsystem::SpawnActors(UWorld* World)
+{
+	const APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(World, 0);
+	const FVector Center = PlayerPawn ? PlayerPawn->GetActorLocation() : FVector::ZeroVector;
+
+	FRandomStream Random(RandomSeed);
+	if (UFixedStepSubsystem* FixedStep = World->GetSubsystem<UFixedStepSubsystem>())
+	{
+		FixedStep->SetSeed(RandomSeed);
+	}
+
+	auto RandomLocation = [&Random, &Center, this](float Height)
+	{
+		const FVector2D Offset = FVector2D(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f)) * SpawnRadius;
+		return Center + FVector(Offset.X, Offset.Y, Height);
+	};
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	UClass* DroneSpawnClass = DroneClass.IsNull() ? ADrone::StaticClass() : DroneClass.LoadSynchronous();
+	for (int32 Index = 0; Index < NumDrones && DroneSpawnClass; ++Index)
+	{
+		TArray<ATargetPoint*> PatrolPoints;
+		for (int32 Point = 0; Point < 3; ++Point)
+		{
+			PatrolPoints.Add(World->SpawnActor<ATargetPoint>(RandomLocation(300.0f), FRotator::ZeroRotator, SpawnParams));
+		}
+
+		if (ADrone* Drone = World->SpawnActor<ADrone>(DroneSpawnClass, RandomLocation(300.0f), FRotator::ZeroRotator, SpawnParams))
+		{
+			Drone->SetDropOffPoint(PatrolPoints[0]);
+			Drone->SetPatrolPoints(PatrolPoints);
+		}
+	}
+
+	UClass* ObstacleSpawnClass = ObstacleClass.IsNull() ? AMovingObstacle::StaticClass() : ObstacleClass.LoadSynchronous();
+	for (int32 Index = 0; Index < NumObstacles && ObstacleSpawnClass; ++Index)
+	{
+		const FTransform Transform(RandomLocation(0.0f));
+		if (AMovingObstacle* Obstacle = World->SpawnActorDeferred<AMovingObstacle>(ObstacleSpawnClass, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn))
+		{
+			Obstacle->SetupAutoLoop();
+			Obstacle->FinishSpawning(Transform);
+		}
+	}
+
+	UE_LOG(LogLevelUpJam, Display, TEXT("Benchmark: spawned %d drones and %d obstacles"), NumDrones, NumObstacles);
+}
+
+bool UBenchmarkSubsystem::Tick(float DeltaTime)
+{
+	if (!CurrentWorld.IsValid() || !Results.IsValidIndex(CurrentMapIndex))
+	{
+		LevelUpJamCounters::Reset();
+		return true;
+	}
+
+	MapElapsed += DeltaTime;
+	DriveInput(DeltaTime);
+
+	// Counters hold the previous frame's totals, as the world ticks after the core ticker
+	for (int32 Counter = 0; Counter < static_cast<int32>(LevelUpJamCounters::ECounter::Num); ++Counter)
+	{
+		const int32 Value = LevelUpJamCounters::Values[Counter];
+#if CSV_PROFILER
+		FCsvProfiler::RecordCustomStat(CounterStatNames[Counter], CSV_CATEGORY_INDEX(LevelUpJam), Value, ECsvCustomStatOp::Set);
+#endif
+
+		if (bMeasuring)
+		{
+			Results[CurrentMapIndex].CounterSums[Counter] += Value;
+		}
+	}
+	LevelUpJamCounters::Reset();
+
+	if (!bMeasuring && MapElapsed >= WarmupSeconds)
+	{
+		bMeasuring = true;
+#if CSV_PROFILER
+		const FString CaptureName = FString::Printf(TEXT("%s.csv"), *FPackageName::GetShortName(Maps[CurrentMapIndex]));
+		FCsvProfiler::Get()->BeginCapture(-1, OutputDir, CaptureName);
+#endif
+
+		// Recording runs over the measured frames only, so its cost shows up in the results
+		if (bRecordReplay)
+		{
+			GetGameInstance()->StartRecordingReplay(GetReplayName(Maps[CurrentMapIndex]), GetReplayName(Maps[CurrentMapIndex]));
+		}
+	}
+
+	if (bMeasuring)
+	{
+		FMapResult& Result = Results[CurrentMapIndex];
+		Result.FrameMs.Add(DeltaTime * 1000.0f);
+		Result.GameThreadMsSum += FPlatformTime::ToMilliseconds(GGameThreadTime);
+		Result.PeakUsedPhysical = FMath::Max<uint64>(Result.PeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+
+		if (MapElapsed >= WarmupSeconds + MeasureSeconds)
+		{
+			FinishMap();
+		}
+	}
+
+	return true;
+}
+
+void UBenchmarkSubsystem::DriveInput(float DeltaTime)
+{
+	if (InputPath.IsEmpty())
+	{
+		return;
+	}
+
+	ACharacter* Character = UGameplayStatics::GetPlayerCharacter(CurrentWorld.Get(), 0);
+	AController* Controller = Character ? Character->GetController() : nullptr;
+	if (!Controller)
+	{
+		return;
+	}
+
+	// Steps are at least a frame long at 60 Hz, so a path of zero durations cannot stall the loop
+	InputElapsed += DeltaTime;
+	for (float StepDuration = FMath::Max(InputPath[InputStep].Duration, BenchmarkInput::MinStepDuration);
+		InputElapsed >= StepDuration;
+		StepDuration = FMath::Max(InputPath[InputStep].Duration, BenchmarkInput::MinStepDuration))
+	{
+		InputElapsed -= StepDuration;
+		InputStep = (InputStep + 1) % InputPath.Num();
+	}
+
+	const FBenchmarkInputStep& Step = InputPath[InputStep];
+
+	FRotator ControlRotation = Controller->GetControlRotation();
+	ControlRotation.Yaw += Step.YawRate * DeltaTime;
+	Controller->SetControlRotation(ControlRotation);
+
+	const FRotator YawRotation(0.0f, ControlRotation.Yaw, 0.0f);
+	Character->AddMovementInput(FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X), Step.Move.Y);
+	Character->AddMovementInput(FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y), Step.Move.X);
+
+	if (Step.bJump)
+	{
+		Character->Jump();
+	}
+}
+
+void UBenchmarkSubsystem::FinishMap()
+{
+	bMeasuring = false;
+
+	if (UObstacleEventBus* EventBus = CurrentWorld.IsValid() ? CurrentWorld->GetSubsystem<UObstacleEventBus>() : nullptr)
+	{
+		EventBus->OnAnyEvents.RemoveAll(this);
+	}
+	CurrentWorld.Reset();
+
+	if (bRecordReplay)
+	{
+		GetGameInstance()->StopRecordingReplay();
+	}
+
+#if CSV_PROFILER
+	FCsvProfiler::Get()->EndCapture();
+#endif
+
+	UE_LOG(LogLevelUpJam, Display, TEXT("Benchmark: finished %s (%d frames)"),
+		*Maps[CurrentMapIndex], Results[CurrentMapIndex].FrameMs.Num());
+
+	OpenNextMap();
+}
+
+TSharedRef<FJsonObject> UBenchmarkSubsystem::MakeMapJson(const FMapResult& Result) const
+{
+	TArray<float> Sorted = Result.FrameMs;
+	Sorted.Sort();
+
+	const int32 NumFrames = FMath::Max(1, Sorted.Num());
+	double FrameMsSum = 0.0;
+	for (const float FrameMs : Sorted)
+	{
+		FrameMsSum += FrameMs;
+	}
+
+	TSharedRef<FJsonObject> MapJson = MakeShared<FJsonObject>();
+	MapJson->SetStringField(TEXT("Map"), Result.Map);
+	if (Result.bLoadFailed)
+	{
+		MapJson->SetBoolField(TEXT("LoadFailed"), true);
+		return MapJson;
+	}
+
+	MapJson->SetNumberField(TEXT("Frames"), Sorted.Num());
+	MapJson->SetNumberField(TEXT("FrameMsAvg"), FrameMsSum / NumFrames);
+	MapJson->SetNumberField(TEXT("FrameMsP95"), Sorted.IsEmpty() ? 0.0f : Sorted[FMath::Min(Sorted.Num() - 1, FMath::FloorToInt32(Sorted.Num() * 0.95f))]);
+	MapJson->SetNumberField(TEXT("GameThreadMsAvg"), Result.GameThreadMsSum / NumFrames);
+	MapJson->SetNumberField(TEXT("PeakUsedPhysicalMB"), Result.PeakUsedPhysical / (1024.0 * 1024.0));
+	MapJson->SetNumberField(TEXT("MapLoadSeconds"), Result.LoadSeconds);
+	MapJson->SetNumberField(TEXT("UsedPhysicalAfterLoadMB"), Result.UsedPhysicalAfterLoad / (1024.0 * 1024.0));
+
+	for (int32 Counter = 0; Counter < static_cast<int32>(LevelUpJamCounters::ECounter::Num); ++Counter)
+	{
+		const FString Name = FString(LevelUpJamCounters::GetName(static_cast<LevelUpJamCounters::ECounter>(Counter))) + TEXT("PerFrame");
+		MapJson->SetNumberField(Name, static_cast<double>(Result.CounterSums[Counter]) / NumFrames);
+	}
+
+	if (bRecordReplay)
+	{
+		const int64 ReplayBytes = FMath::Max<int64>(0, IFileManager::Get().FileSize(*LevelUpJamReplay::GetReplayFilePath(GetReplayName(Result.Map))));
+		MapJson->SetNumberField(TEXT("ReplayKB"), ReplayBytes / 1024.0);
+		MapJson->SetNumberField(TEXT("ReplayKBPerMinute"), ReplayBytes / 1024.0 / FMath::Max(MeasureSeconds / 60.0f, UE_KINDA_SMALL_NUMBER));
+	}
+
+	return MapJson;
+}
+
+FString UBenchmarkSubsystem::GetReplayName(const FString& Map)
+{
+	return FString::Printf(TEXT("Benchmark_%s"), *FPackageName::GetShortName(Map));
+}
+
+void UBenchmarkSubsystem::WriteReport()
+{
+	TArray<TSharedPtr<FJsonValue>> MapReports;
+	int32 NumFailedMaps = 0;
+	for (const FMapResult& Result : Results)
+	{
+		MapReports.Add(MakeShared<FJsonValueObject>(MakeMapJson(Result)));
+		NumFailedMaps += Result.bLoadFailed;
+	}
+
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetNumberField(TEXT("Drones"), NumDrones);
+	Report->SetNumberField(TEXT("Obstacles"), NumObstacles);
+	Report->SetNumberField(TEXT("MeasureSeconds"), MeasureSeconds);
+	Report->SetArrayField(TEXT("Maps"), MapReports);
+
+	FString ReportText;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ReportText);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	const FString ReportPath = OutputDir / TEXT("Report.json");
+	FFileHelper::SaveStringToFile(ReportText, *ReportPath);
+	UE_LOG(LogLevelUpJam, Display, TEXT("Benchmark: report written to %s"), *ReportPath);
+
+	const bool bRegressed = !BaselinePath.IsEmpty() && CompareWithBaseline(MapReports);
+
+	FPlatformMisc::RequestExitWithStatus(false, bRegressed || NumFailedMaps > 0 ? 1 : 0);
+}
+
+bool UBenchmarkSubsystem::CompareWithBaseline(const TArray<TSharedPtr<FJsonValue>>& MapReports) const
+{
+	FString BaselineText;
+	TSharedPtr<FJsonObject> Baseline;
+	if (!FFileHelper::LoadFileToString(BaselineText, *BaselinePath)
+		|| !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(BaselineText), Baseline)
+		|| !Baseline.IsValid())
+	{
+		UE_LOG(LogLevelUpJam, Error, TEXT("Benchmark: could not read baseline %s"), *BaselinePath);
+		return true;
+	}
+
+	// Lower is better for every metric in the report
+	static const TCHAR* ComparedMetrics[] =
+	{
+		TEXT("FrameMsAvg"), TEXT("FrameMsP95"), TEXT("GameThreadMsAvg"), TEXT("PeakUsedPhysicalMB"),
+		TEXT("UsedPhysicalAfterLoadMB"), TEXT("LineTracesPerFrame"), TEXT("OverlapEventsPerFrame")
+	};
+
+	bool bRegressed = false;
+	for (const TSharedPtr<FJsonValue>& BaselineValue : Baseline->GetArrayField(TEXT("Maps")))
+	{
+		const TSharedPtr<FJsonObject> BaselineMap = BaselineValue->AsObject();
+		const FString MapName = BaselineMap->GetStringField(TEXT("Map"));
+
+		const TSharedPtr<FJsonValue>* CurrentValue = MapReports.FindByPredicate([&MapName](const TSharedPtr<FJsonValue>& Value)
+		{
+			return Value->AsObject()->GetStringField(TEXT("Map")) == MapName;
+		});
+		if (!CurrentValue)
+		{
+			continue;
+		}
+
+		const TSharedPtr<FJsonObject> CurrentMap = (*CurrentValue)->AsObject();
+		if (CurrentMap->HasField(TEXT("LoadFailed")))
+		{
+			continue;
+		}
+
+		for (const TCHAR* Metric : ComparedMetrics)
+		{
+			// Baselines from before a metric was added do not have it
+			double Expected = 0.0;
+			if (!BaselineMap->TryGetNumberField(Metric, Expected))
+			{
+				continue;
+			}
+
+			const double Actual = CurrentMap->GetNumberField(Metric);
+			if (Actual > Expected * (1.0 + RegressionTolerance) + UE_KINDA_SMALL_NUMBER)
+			{
+				UE_LOG(LogLevelUpJam, Error, TEXT("Benchmark regression on %s: %s %.3f vs baseline %.3f"),
+					*MapName, Metric, Actual, Expected);
+				bRegressed = true;
+			}
+		}
+	}
+
+	return bRegressed;
+}
@@ -2,12 +2,19 @@
 
 #include "BoxCharacter.h"
 #include "Camera/CameraComponent.h"
+#include "Components/CapsuleComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "InputMappingContext.h"
 #include "RespawnPoint.h"
+#include "InputRecorderComponent.h"
+#include "DamageSubsystem.h"
+#include "HUDViewModelSubsystem.h"
+#include "RoomStreamingSubsystem.h"
+#include "LevelUpJam.h"
+#include "Boxes/PhysicsBudgetSubsystem.h"
 #include "EngineUtils.h"
 
 // Sets default values
@@ -16,6 +23,8 @@ ABoxCharacter::ABoxCharacter()
 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	GetCapsuleComponent()->SetCollisionProfileName(LevelUpJamCollision::PlayerProfile);
+
 	// Create Spring Arm Component
 	SpringArmComponent = CreateDefaultSubobject<USpringArmComponent>(TEXT("SpringArm"));
 	SpringArmComponent->SetupAttachment(RootComponent);
@@ -29,6 +38,8 @@ ABoxCharacter::ABoxCharacter()
 	CameraComponent = CreateDefaultSubobject<UCameraComponent>(TEXT("Camera"));
 	CameraComponent->SetupAttachment(SpringArmComponent, USpringArmComponent::SocketName);
 
+	InputRecorder = CreateDefaultSubobject<UInputRecorderComponent>(TEXT("InputRecorder"));
+
 	// Configure Character Movement
 	GetCharacterMovement()->bOrientRotationToMovement = true;
 	GetCharacterMovement()->RotationRate = FRotator(0.0f, 540.0f, 0.0f);
@@ -65,11 +76,30 @@ void ABoxCharacter::BeginPlay()
 		{
 			if (It->RespawnID == "Start")
 			{
-				CurrentRespawnPoint = *It;
+				// A character spawned after a death must not stream the rooms back to the start
+				const URoomStreamingSubsystem* RoomStreaming = GetWorld()->GetSubsystem<URoomStreamingSubsystem>();
+				if (RoomStreaming && RoomStreaming->HasPlayerRoom())
+				{
+					CurrentRespawnPoint = *It;
+				}
+				else
+				{
+					SetRespawnPoint(*It);
+				}
 				break;
 			}
 		}
 	}
+
+	if (UHUDViewModelSubsystem* HUDViewModel = GetWorld()->GetSubsystem<UHUDViewModelSubsystem>())
+	{
+		HUDViewModel->SetPlayer(this);
+	}
+
+	if (UPhysicsBudgetSubsystem* PhysicsBudget = GetWorld()->GetSubsystem<UPhysicsBudgetSubsystem>())
+	{
+		PhysicsBudget->RegisterWakeSource(this);
+	}
 }
 
 // Called every frame
@@ -101,7 +131,8 @@ void ABoxCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCompon
 		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Completed, this, &ACharacter::StopJumping);
 		
 		EnhancedInputComponent->BindAction(DodgeAction, ETriggerEvent::Triggered, this, &ABoxCharacter::Dodge);
-		
+
+		InputRecorder->SetupBindings(DefaultMappingContext, { MoveAction, MoveForwardAction, MoveBackwardAction, LookAction, JumpAction, DodgeAction });
 	}
 }
 
@@ -176,22 +207,51 @@ void ABoxCharacter::MoveBackward(const FInputActionValue& Value)
 // Called when the character takes damage
 void ABoxCharacter::ReceiveDamage(int32 DamageAmount)
 {
-	if (Health <= 0) return;
+	// Nothing to apply; a negative amount must not fall through to the damage table default
+	if (DamageAmount <= 0)
+	{
+		return;
+	}
 
-	Health -= DamageAmount;
+	if (UDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UDamageSubsystem>())
+	{
+		DamageSubsystem->QueueDamage(this, EDamageKind::Generic, nullptr, DamageAmount);
+		return;
+	}
 
-	if (GEngine)
+	// No subsystem (e.g. a world type that does not create it): apply right away
+	if (!IsInvulnerable(GetWorld()->GetTimeSeconds()))
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Yellow, FString::Printf(TEXT("BoxCharacter Health: %d"), Health));
+		ApplyResolvedDamage(FMath::RoundToInt32(DamageAmount * (1.0f - GetDamageResistance(EDamageKind::Generic))), InvulnerableUntil);
+	}
+}
+
+void ABoxCharacter::ApplyResolvedDamage(int32 DamageAmount, double NewInvulnerableUntil)
+{
+	if (Health <= 0 || DamageAmount <= 0) return;
+
+	Health = FMath::Max(Health - DamageAmount, 0);
+	InvulnerableUntil = NewInvulnerableUntil;
+
+	UE_LOG(LogLevelUpJam, Verbose, TEXT("%s took %d damage, health %d"), *GetName(), DamageAmount, Health);
+
+	if (UHUDViewModelSubsystem* HUDViewModel = GetWorld()->GetSubsystem<UHUDViewModelSubsystem>())
+	{
+		HUDViewModel->SetHealth(this, Health);
 	}
 
 	if (Health <= 0)
 	{
-		Health = 0;
 		OnDeath();
 	}
 }
 
+float ABoxCharacter::GetDamageResistance(EDamageKind Kind) const
+{
+	const float* Resistance = DamageResistances.Find(Kind);
+	return Resistance ? FMath::Clamp(*Resistance, 0.0f, 1.0f) : 0.0f;
+}
+
 void ABoxCharacter::OnDeath_Implementation()
 {
 	// Core C++ death logic: disable input, destroy actor, etc.
@@ -206,6 +266,33 @@ void ABoxCharacter::OnDeath_Implementation()
 	BP_OnDeath();
 }
 
+void ABoxCharacter::SetRespawnPoint(ARespawnPoint* NewRespawnPoint)
+{
+	CurrentRespawnPoint = NewRespawnPoint;
+
+	// Rooms stream along the checkpoints the player reaches
+	if (URoomStreamingSubsystem* RoomStreaming = GetWorld()->GetSubsystem<URoomStreamingSubsystem>())
+	{
+		RoomStreaming->OnRespawnPointChanged(this, NewRespawnPoint);
+	}
+
+	if (UHUDViewModelSubsystem* HUDViewModel = GetWorld()->GetSubsystem<UHUDViewModelSubsystem>())
+	{
+		HUDViewModel->SetCheckpoint(this, NewRespawnPoint ? NewRespawnPoint->RespawnID : NAME_None);
+	}
+}
+
+void ABoxCharacter::NotifyControllerChanged()
+{
+	Super::NotifyControllerChanged();
+
+	// The HUD follows whichever character the local player possesses
+	if (UHUDViewModelSubsystem* HUDViewModel = GetWorld()->GetSubsystem<UHUDViewModelSubsystem>())
+	{
+		HUDViewModel->SetPlayer(this);
+	}
+}
+
 void ABoxCharacter::NotifyActorBeginOverlap(AActor* OtherActor)
 {
     Super::NotifyActorBeginOverlap(OtherActor);
@@ -216,11 +303,8 @@ void ABoxCharacter::NotifyActorBeginOverlap(AActor* OtherActor)
         FName CurrentID = CurrentRespawnPoint ? CurrentRespawnPoint->RespawnID : NAME_None;
         if (NewID != CurrentID)
         {
+            // The HUD view-model shows the new checkpoint
             SetRespawnPoint(Respawn);
-            if (GEngine)
-            {
-                GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Green, FString::Printf(TEXT("Checkpoint reached: %s"), *NewID.ToString()));
-            }
             // Call Blueprint logic for checkpoint update
             BP_OnDeath(); // Or your BP respawn/update function
         }
@@ -228,3 +312,62 @@ void ABoxCharacter::NotifyActorBeginOverlap(AActor* OtherActor)
 }
 
 
+
+void ABoxCharacter::BeginCarried(USceneComponent* Carrier, FName Socket)
+{
+	if (!Carrier || IsCarried())
+	{
+		return;
+	}
+
+	UCharacterMovementComponent* Movement = GetCharacterMovement();
+	PreCarryMovementMode = Movement->MovementMode;
+	PreCarryCustomMode = Movement->CustomMovementMode;
+	PreCarryVelocity = Movement->Velocity;
+
+	// The custom mode keeps anything else from moving the character, and with the tick off there
+	// are no floor checks or sweeps at all
+	Movement->StopMovementImmediately();
+	Movement->SetMovementMode(MOVE_Custom, static_cast<uint8>(EBoxMovementMode::Carried));
+	Movement->SetComponentTickEnabled(false);
+
+	const FAttachmentTransformRules AttachRules = Socket.IsNone()
+		? FAttachmentTransformRules::KeepWorldTransform
+		: FAttachmentTransformRules::SnapToTargetNotIncludingScale;
+	AttachToComponent(Carrier, AttachRules, Socket);
+}
+
+bool ABoxCharacter::EndCarried(const FVector& DropLocation)
+{
+	if (!IsCarried())
+	{
+		return false;
+	}
+
+	DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+
+	// Restored before the teleport so it finds the floor for the right mode
+	UCharacterMovementComponent* Movement = GetCharacterMovement();
+	Movement->SetComponentTickEnabled(true);
+	Movement->SetMovementMode(PreCarryMovementMode, PreCarryCustomMode);
+
+	// A socket may have tilted the character
+	const FRotator DropRotation(0.0f, GetActorRotation().Yaw, 0.0f);
+
+	// TeleportTo moves the spot out of any geometry before placing the capsule
+	const bool bPlaced = TeleportTo(DropLocation, DropRotation);
+	if (!bPlaced)
+	{
+		UE_LOG(LogLevelUpJam, Warning, TEXT("%s: no free spot to drop at %s, placing without a check."), *GetName(), *DropLocation.ToString());
+		SetActorLocationAndRotation(DropLocation, DropRotation, false, nullptr, ETeleportType::TeleportPhysics);
+	}
+
+	Movement->Velocity = PreCarryVelocity;
+	return bPlaced;
+}
+
+bool ABoxCharacter::IsCarried() const
+{
+	const UCharacterMovementComponent* Movement = GetCharacterMovement();
+	return Movement->MovementMode == MOVE_Custom && Movement->CustomMovementMode == static_cast<uint8>(EBoxMovementMode::Carried);
+}
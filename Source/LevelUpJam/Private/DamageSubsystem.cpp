@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DamageSubsystem.h"
+#include "BoxCharacter.h"
+#include "LevelUpJam.h"
+#include "Engine/DataTable.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+void UDamageSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const UEnum* KindEnum = StaticEnum<EDamageKind>();
+	const int32 NumKinds = KindEnum->NumEnums() - 1; // Skip the generated _MAX entry
+	DamageRows.SetNum(NumKinds);
+
+	// Built-in defaults, matching the values that used to be hardcoded at the call sites
+	DamageRows[static_cast<int32>(EDamageKind::DroneGrab)].Amount = 30;
+	DamageRows[static_cast<int32>(EDamageKind::Launch)].Amount = 10;
+	DamageRows[static_cast<int32>(EDamageKind::Launch)].InvulnerabilityTime = 0.5f;
+
+	LoadedDamageTable = DamageTable.LoadSynchronous();
+	if (!LoadedDamageTable)
+	{
+		return;
+	}
+
+	for (int32 KindIndex = 0; KindIndex < NumKinds; ++KindIndex)
+	{
+		const FName RowName(*KindEnum->GetNameStringByIndex(KindIndex));
+		if (const FDamageTableRow* Row = LoadedDamageTable->FindRow<FDamageTableRow>(RowName, TEXT("UDamageSubsystem"), false))
+		{
+			DamageRows[KindIndex] = *Row;
+		}
+	}
+}
+
+void UDamageSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ResolvePendingDamage();
+}
+
+TStatId UDamageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDamageSubsystem, STATGROUP_Tickables);
+}
+
+void UDamageSubsystem::QueueDamage(ABoxCharacter* Target, EDamageKind Kind, AActor* Source, int32 AmountOverride)
+{
+	if (!Target)
+	{
+		return;
+	}
+
+	FQueuedDamage& Damage = PendingDamage.AddDefaulted_GetRef();
+	Damage.Target = Target;
+	Damage.Source = Source;
+	Damage.Kind = Kind;
+	Damage.AmountOverride = AmountOverride;
+}
+
+FDamageTableRow UDamageSubsystem::GetDamageRow(EDamageKind Kind) const
+{
+	const int32 KindIndex = static_cast<int32>(Kind);
+	return DamageRows.IsValidIndex(KindIndex) ? DamageRows[KindIndex] : FDamageTableRow();
+}
+
+void UDamageSubsystem::ResolvePendingDamage()
+{
+	if (PendingDamage.IsEmpty())
+	{
+		return;
+	}
+
+	// Swap the buffer out so anything queued from OnDeath lands in the next frame
+	TArray<FQueuedDamage> Events = MoveTemp(PendingDamage);
+	PendingDamage.Reset();
+
+	ResolveDamage(Events);
+}
+
+void UDamageSubsystem::ResolveDamage(TArray<FQueuedDamage>& Events)
+{
+	// Group hits by target so each character is resolved exactly once
+	Events.Sort([](const FQueuedDamage& A, const FQueuedDamage& B)
+	{
+		return A.Target.Get() < B.Target.Get();
+	});
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	for (int32 First = 0; First < Events.Num();)
+	{
+		ABoxCharacter* Target = Events[First].Target.Get();
+
+		int32 Last = First;
+		while (Last < Events.Num() && Events[Last].Target.Get() == Target)
+		{
+			++Last;
+		}
+
+		if (Target && !Target->IsDead() && !Target->IsInvulnerable(Now))
+		{
+			float TotalDamage = 0.0f;
+			float InvulnerabilityTime = 0.0f;
+
+			for (int32 Index = First; Index < Last; ++Index)
+			{
+				const FQueuedDamage& Damage = Events[Index];
+				const FDamageTableRow Row = GetDamageRow(Damage.Kind);
+				const int32 Amount = Damage.AmountOverride >= 0 ? Damage.AmountOverride : Row.Amount;
+
+				TotalDamage += Amount * (1.0f - Target->GetDamageResistance(Damage.Kind));
+				InvulnerabilityTime = FMath::Max(InvulnerabilityTime, Row.InvulnerabilityTime);
+			}
+
+			const int32 RoundedDamage = FMath::RoundToInt32(TotalDamage);
+			if (RoundedDamage > 0)
+			{
+				Target->ApplyResolvedDamage(RoundedDamage, Now + InvulnerabilityTime);
+			}
+		}
+
+		First = Last;
+	}
+}
+
+// Floods the buffer with synthetic hits against every BoxCharacter in the world and times the resolve pass
+static FAutoConsoleCommandWithWorldAndArgs GDamageStressCommand(
+	TEXT("LevelUpJam.Damage.Stress"),
+	TEXT("Queue N synthetic damage events (default 10000) and resolve them immediately. Usage: LevelUpJam.Damage.Stress [N]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UDamageSubsystem* DamageSubsystem = World ? World->GetSubsystem<UDamageSubsystem>() : nullptr;
+		if (!DamageSubsystem)
+		{
+			return;
+		}
+
+		TArray<ABoxCharacter*> Targets;
+		for (TActorIterator<ABoxCharacter> It(World); It; ++It)
+		{
+			Targets.Add(*It);
+		}
+
+		if (Targets.IsEmpty())
+		{
+			UE_LOG(LogLevelUpJam, Warning, TEXT("Damage stress: no BoxCharacter in the world."));
+			return;
+		}
+
+		const int32 NumEvents = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000;
+		const int32 NumKinds = StaticEnum<EDamageKind>()->NumEnums() - 1;
+
+		// A separate batch, real hits queued this frame still resolve at the end of it
+		TArray<FQueuedDamage> Events;
+		Events.Reserve(NumEvents);
+		for (int32 Index = 0; Index < NumEvents; ++Index)
+		{
+			// Zero damage keeps the characters alive so the run measures the resolve cost only
+			FQueuedDamage& Damage = Events.AddDefaulted_GetRef();
+			Damage.Target = Targets[Index % Targets.Num()];
+			Damage.Kind = static_cast<EDamageKind>(Index % NumKinds);
+			Damage.AmountOverride = 0;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		DamageSubsystem->ResolveDamage(Events);
+		const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		UE_LOG(LogLevelUpJam, Display, TEXT("Damage stress: resolved %d events for %d targets in %.3f ms"),
+			NumEvents, Targets.Num(), ElapsedMs);
+	}));
@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DormancySubsystem.h"
+#include "DormantActor.h"
+#include "FixedStepSubsystem.h"
+#include "LevelUpJam.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Actors Awake"), STAT_DormancyAwake, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Actors Dormant"), STAT_DormancyDormant, STATGROUP_LevelUpJam);
+
+void UDormancySubsystem::Deinitialize()
+{
+	Entries.Reset();
+	NumDormant = 0;
+
+	Super::Deinitialize();
+}
+
+void UDormancySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeSinceCheck += DeltaTime;
+	if (TimeSinceCheck >= CheckInterval)
+	{
+		TimeSinceCheck = 0.0f;
+		UpdateDormancy();
+	}
+
+	SET_DWORD_STAT(STAT_DormancyAwake, GetNumAwake());
+	SET_DWORD_STAT(STAT_DormancyDormant, NumDormant);
+	CSV_CUSTOM_STAT(LevelUpJam, ActorsAwake, GetNumAwake(), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(LevelUpJam, ActorsDormant, NumDormant, ECsvCustomStatOp::Set);
+}
+
+TStatId UDormancySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDormancySubsystem, STATGROUP_Tickables);
+}
+
+void UDormancySubsystem::RegisterActor(AActor* Actor)
+{
+	IDormantActor* Dormant = Cast<IDormantActor>(Actor);
+	if (!Dormant)
+	{
+		return;
+	}
+
+	Entries.Add({ Actor, Dormant });
+}
+
+void UDormancySubsystem::UnregisterActor(AActor* Actor)
+{
+	const int32 Index = Entries.IndexOfByPredicate([Actor](const FEntry& Entry) { return Entry.Actor == Actor; });
+	if (Index != INDEX_NONE)
+	{
+		NumDormant -= Entries[Index].IsDormant() ? 1 : 0;
+		Entries.RemoveAtSwap(Index, EAllowShrinking::No);
+	}
+}
+
+void UDormancySubsystem::SetEnabled(bool bInEnabled)
+{
+	bEnabled = bInEnabled;
+
+	if (!bEnabled)
+	{
+		for (FEntry& Entry : Entries)
+		{
+			if (Entry.IsDormant() && Entry.Actor.IsValid())
+			{
+				Wake(Entry);
+			}
+		}
+	}
+}
+
+void UDormancySubsystem::UpdateDormancy()
+{
+	PlayerLocations.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			PlayerLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+
+	// A fixed step run must simulate everything to replay identically
+	const UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>();
+	const bool bCanSleep = bEnabled && !PlayerLocations.IsEmpty() && !(FixedStep && FixedStep->IsEnabled());
+
+	for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+	{
+		FEntry& Entry = Entries[Index];
+		const AActor* Actor = Entry.Actor.Get();
+		if (!Actor)
+		{
+			NumDormant -= Entry.IsDormant() ? 1 : 0;
+			Entries.RemoveAtSwap(Index, EAllowShrinking::No);
+			continue;
+		}
+
+		// Without a player (loading, commandlets) there is nothing to measure against
+		if (!bCanSleep)
+		{
+			continue;
+		}
+
+		const float Distance = Entry.Dormant->GetDormancyDistance() > 0.0f ? Entry.Dormant->GetDormancyDistance() : DefaultDormancyDistance;
+		const float Threshold = Entry.IsDormant() ? Distance : Distance + Hysteresis;
+
+		const FVector Location = Actor->GetActorLocation();
+		const bool bPlayerNear = PlayerLocations.ContainsByPredicate([&Location, Threshold](const FVector& PlayerLocation)
+		{
+			return FVector::DistSquared(PlayerLocation, Location) <= FMath::Square(Threshold);
+		});
+
+		if (Entry.IsDormant() && bPlayerNear)
+		{
+			Wake(Entry);
+		}
+		else if (!Entry.IsDormant() && !bPlayerNear && Entry.Dormant->CanEnterDormancy())
+		{
+			Entry.Dormant->EnterDormancy();
+			Entry.DormantSince = GetWorld()->GetTimeSeconds();
+			++NumDormant;
+		}
+	}
+}
+
+void UDormancySubsystem::Wake(FEntry& Entry)
+{
+	const float DormantSeconds = static_cast<float>(GetWorld()->GetTimeSeconds() - Entry.DormantSince);
+	Entry.DormantSince = -1.0;
+	--NumDormant;
+
+	Entry.Dormant->ExitDormancy(DormantSeconds);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GDormancyEnableCommand(
+	TEXT("LevelUpJam.Dormancy.Enable"),
+	TEXT("Enable or disable obstacle and drone dormancy, to compare tick cost. Usage: LevelUpJam.Dormancy.Enable 0|1"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UDormancySubsystem* Dormancy = World ? World->GetSubsystem<UDormancySubsystem>() : nullptr)
+		{
+			Dormancy->SetEnabled(Args.Num() == 0 || FCString::Atoi(*Args[0]) != 0);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GDormancyReportCommand(
+	TEXT("LevelUpJam.Dormancy.Report"),
+	TEXT("Log how many registered actors are awake and dormant."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (const UDormancySubsystem* Dormancy = World ? World->GetSubsystem<UDormancySubsystem>() : nullptr)
+		{
+			UE_LOG(LogLevelUpJam, Display, TEXT("Dormancy: %d awake, %d dormant."), Dormancy->GetNumAwake(), Dormancy->GetNumDormant());
+		}
+	}));
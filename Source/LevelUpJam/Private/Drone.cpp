@@ -2,6 +2,16 @@
 
 #include "Drone.h"
 #include "BoxCharacter.h"
+#include "DamageSubsystem.h"
+#include "SafeZoneSubsystem.h"
+#include "SafeZoneField.h"
+#include "DormancySubsystem.h"
+#include "DroneAvoidanceSubsystem.h"
+#include "DronePerceptionSubsystem.h"
+#include "HUDViewModelSubsystem.h"
+#include "FixedStepSubsystem.h"
+#include "LevelUpJam.h"
+#include "Boxes/PhysicsBudgetSubsystem.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/SphereComponent.h"
 #include "GameFramework/FloatingPawnMovement.h"
@@ -10,6 +20,16 @@
 #include "TimerManager.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Engine/Engine.h"
+#include "Net/UnrealNetwork.h"
+
+namespace DroneReplication
+{
+	// Snapshots are not extrapolated further than this, a stopped drone sends a new one before
+	constexpr float MaxExtrapolationSeconds = 1.0f;
+
+	// Further than this from the replicated location a copy jumps instead of blending, e.g. after a scrub
+	constexpr float SnapDistance = 500.0f;
+}
 
 // Sets default values
 ADrone::ADrone()
@@ -23,22 +43,19 @@ ADrone::ADrone()
 	// Create and setup Drone Mesh
 	DroneMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("DroneMesh"));
 	DroneMesh->SetupAttachment(RootComponent);
+	DroneMesh->SetCollisionProfileName(LevelUpJamCollision::DroneProfile);
 
 	// Create and setup Detection Sphere
 	DetectionSphere = CreateDefaultSubobject<USphereComponent>(TEXT("DetectionSphere"));
 	DetectionSphere->SetupAttachment(RootComponent);
 	DetectionSphere->SetSphereRadius(DetectionRadius);
-	DetectionSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-	DetectionSphere->SetCollisionResponseToAllChannels(ECR_Ignore);
-	DetectionSphere->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
+	DetectionSphere->SetCollisionProfileName(LevelUpJamCollision::PlayerTriggerProfile);
 
 	// Create and setup Interaction Sphere
 	InteractionSphere = CreateDefaultSubobject<USphereComponent>(TEXT("InteractionSphere"));
 	InteractionSphere->SetupAttachment(RootComponent);
 	InteractionSphere->SetSphereRadius(InteractionRadius);
-	InteractionSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-	InteractionSphere->SetCollisionResponseToAllChannels(ECR_Ignore);
-	InteractionSphere->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
+	InteractionSphere->SetCollisionProfileName(LevelUpJamCollision::PlayerTriggerProfile);
 
 	// Create and setup Floating Movement Component
 	FloatingMovement = CreateDefaultSubobject<UFloatingPawnMovement>(TEXT("FloatingMovement"));
@@ -54,6 +71,11 @@ ADrone::ADrone()
 	bIsWaitingAtPatrol = false;
 	bPlayerInSight = false;
 
+	// Only the compact state replicates, see FDroneReplicatedState
+	bReplicates = true;
+	SetReplicatingMovement(false);
+	SetNetUpdateFrequency(10.0f);
+
 	// Bind overlap events
 	DetectionSphere->OnComponentBeginOverlap.AddDynamic(this, &ADrone::OnDetectionSphereBeginOverlap);
 	DetectionSphere->OnComponentEndOverlap.AddDynamic(this, &ADrone::OnDetectionSphereEndOverlap);
@@ -69,12 +91,84 @@ void ADrone::BeginPlay()
 	DetectionSphere->SetSphereRadius(DetectionRadius);
 	InteractionSphere->SetSphereRadius(InteractionRadius);
 
+	if (UHUDViewModelSubsystem* HUDViewModel = GetWorld()->GetSubsystem<UHUDViewModelSubsystem>())
+	{
+		HUDViewModel->AddDrone(CurrentState);
+	}
+
+	// Copies without authority (clients, replays) only present the replicated state
+	if (!HasAuthority())
+	{
+		FloatingMovement->SetComponentTickEnabled(false);
+		DetectionSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		InteractionSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		return;
+	}
+
 	// Start patrolling if we have patrol points
 	if (PatrolPoints.Num() > 0)
 	{
 		ChangeState(EDroneState::Patrolling);
 		SetNewPatrolTarget();
 	}
+
+	if (USafeZoneSubsystem* SafeZones = GetWorld()->GetSubsystem<USafeZoneSubsystem>())
+	{
+		SafeStateChangedHandle = SafeZones->OnPlayerSafeStateChanged.AddUObject(this, &ADrone::OnPlayerSafeStateChanged);
+	}
+
+	if (UPhysicsBudgetSubsystem* PhysicsBudget = GetWorld()->GetSubsystem<UPhysicsBudgetSubsystem>())
+	{
+		PhysicsBudget->RegisterWakeSource(this);
+	}
+
+	if (UDormancySubsystem* Dormancy = GetWorld()->GetSubsystem<UDormancySubsystem>())
+	{
+		Dormancy->RegisterActor(this);
+	}
+
+	if (UDroneAvoidanceSubsystem* Avoidance = GetWorld()->GetSubsystem<UDroneAvoidanceSubsystem>())
+	{
+		Avoidance->RegisterDrone(this, AvoidanceRadius);
+	}
+
+	UFixedStepSubsystem* FixedStepSubsystem = GetWorld()->GetSubsystem<UFixedStepSubsystem>();
+	if (FixedStepSubsystem && FixedStepSubsystem->IsEnabled())
+	{
+		bUseFixedStep = true;
+		FloatingMovement->SetComponentTickEnabled(false);
+
+		SimLocation = PreviousSimLocation = GetActorLocation();
+		SimRotation = PreviousSimRotation = GetActorRotation();
+		FixedStepHandle = FixedStepSubsystem->OnFixedStep.AddUObject(this, &ADrone::FixedStep);
+		PresentHandle = FixedStepSubsystem->OnPresent.AddUObject(this, &ADrone::PresentFixedStep);
+	}
+}
+
+void ADrone::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USafeZoneSubsystem* SafeZones = GetWorld()->GetSubsystem<USafeZoneSubsystem>())
+	{
+		SafeZones->OnPlayerSafeStateChanged.Remove(SafeStateChangedHandle);
+	}
+
+	if (UFixedStepSubsystem* FixedStepSubsystem = GetWorld()->GetSubsystem<UFixedStepSubsystem>())
+	{
+		FixedStepSubsystem->OnFixedStep.Remove(FixedStepHandle);
+		FixedStepSubsystem->OnPresent.Remove(PresentHandle);
+	}
+
+	if (UDroneAvoidanceSubsystem* Avoidance = GetWorld()->GetSubsystem<UDroneAvoidanceSubsystem>())
+	{
+		Avoidance->UnregisterDrone(this);
+	}
+
+	if (UHUDViewModelSubsystem* HUDViewModel = GetWorld()->GetSubsystem<UHUDViewModelSubsystem>())
+	{
+		HUDViewModel->RemoveDrone(CurrentState);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -82,6 +176,29 @@ void ADrone::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::DroneTicks);
+
+	if (!HasAuthority())
+	{
+		PresentReplicatedState(DeltaTime);
+	}
+	else if (!bUseFixedStep)
+	{
+		SimulateDrone(DeltaTime);
+		UpdateReplicatedState(GetVelocity());
+	}
+}
+
+void ADrone::SimulateDrone(float DeltaTime)
+{
+	SimDeltaSeconds = DeltaTime;
+
+	// A carried player stays the target until dropped
+	if (CurrentState != EDroneState::Carrying)
+	{
+		SelectTarget();
+	}
+
 	// Update sight detection
 	if (DetectedPlayer)
 	{
@@ -91,6 +208,104 @@ void ADrone::Tick(float DeltaTime)
 	UpdateCurrentState();
 }
 
+void ADrone::FixedStep(float StepSeconds)
+{
+	// Dormant drones do not tick
+	if (!IsActorTickEnabled())
+	{
+		return;
+	}
+
+	// Gameplay checks run against the simulated pose, not the interpolated one
+	PreviousSimLocation = SimLocation;
+	PreviousSimRotation = SimRotation;
+	SetActorLocationAndRotation(SimLocation, SimRotation);
+
+	SimulateDrone(StepSeconds);
+	UpdateReplicatedState((SimLocation - PreviousSimLocation) / StepSeconds);
+}
+
+void ADrone::PresentFixedStep(float Alpha)
+{
+	if (IsActorTickEnabled())
+	{
+		SetActorLocationAndRotation(FMath::Lerp(PreviousSimLocation, SimLocation, Alpha),
+			FQuat::Slerp(PreviousSimRotation.Quaternion(), SimRotation.Quaternion(), Alpha));
+	}
+}
+
+// Replication
+void ADrone::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ADrone, ReplicatedState);
+}
+
+void ADrone::UpdateReplicatedState(const FVector& Velocity)
+{
+	// Nothing consumes the state while playing standalone
+	if (!LevelUpJamReplay::IsRecordingState(GetWorld()))
+	{
+		return;
+	}
+
+	const FVector Location = GetActorLocation();
+	const FRotator Rotation = GetActorRotation();
+
+	const bool bStateChanged = ReplicatedState.State != CurrentState;
+	const bool bDrifted = FVector::DistSquared(GetReplicatedLocation(), Location) > FMath::Square(ReplicationTolerance);
+	const bool bTurned = !GetReplicatedRotation().Equals(Rotation, 10.0f);
+	if (!bStateChanged && !bDrifted && !bTurned)
+	{
+		return;
+	}
+
+	ReplicatedState.Location = Location;
+	ReplicatedState.Velocity = Velocity;
+	ReplicatedState.Pitch = FRotator::CompressAxisToShort(Rotation.Pitch);
+	ReplicatedState.Yaw = FRotator::CompressAxisToShort(Rotation.Yaw);
+	ReplicatedState.State = CurrentState;
+	ReplicatedState.SnapshotTime = LevelUpJamReplay::GetStateTime(GetWorld());
+
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::ReplicatedStates);
+}
+
+FVector ADrone::GetReplicatedLocation() const
+{
+	const float SnapshotAge = static_cast<float>(LevelUpJamReplay::GetStateTime(GetWorld()) - ReplicatedState.SnapshotTime);
+	return ReplicatedState.Location + ReplicatedState.Velocity * FMath::Clamp(SnapshotAge, 0.0f, DroneReplication::MaxExtrapolationSeconds);
+}
+
+FRotator ADrone::GetReplicatedRotation() const
+{
+	return FRotator(FRotator::DecompressAxisFromShort(ReplicatedState.Pitch), FRotator::DecompressAxisFromShort(ReplicatedState.Yaw), 0.0f);
+}
+
+void ADrone::OnRep_ReplicatedState()
+{
+	// Before BeginPlay the drone is not counted yet, it registers with the replicated state
+	UHUDViewModelSubsystem* HUDViewModel = GetWorld()->GetSubsystem<UHUDViewModelSubsystem>();
+	if (HUDViewModel && HasActorBegunPlay())
+	{
+		HUDViewModel->ChangeDroneState(CurrentState, ReplicatedState.State);
+	}
+	CurrentState = ReplicatedState.State;
+
+	const FVector Location = GetReplicatedLocation();
+	if (FVector::DistSquared(Location, GetActorLocation()) > FMath::Square(DroneReplication::SnapDistance))
+	{
+		SetActorLocationAndRotation(Location, GetReplicatedRotation());
+	}
+}
+
+void ADrone::PresentReplicatedState(float DeltaTime)
+{
+	// Blends out the correction when a new snapshot arrives
+	SetActorLocationAndRotation(FMath::VInterpTo(GetActorLocation(), GetReplicatedLocation(), DeltaTime, 10.0f),
+		FMath::RInterpTo(GetActorRotation(), GetReplicatedRotation(), DeltaTime, 10.0f));
+}
+
 // Called to bind functionality to input
 void ADrone::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
@@ -113,6 +328,10 @@ void ADrone::ChangeState(EDroneState NewState)
 			break;
 		}
 
+		if (UHUDViewModelSubsystem* HUDViewModel = GetWorld()->GetSubsystem<UHUDViewModelSubsystem>())
+		{
+			HUDViewModel->ChangeDroneState(CurrentState, NewState);
+		}
 		CurrentState = NewState;
 
 		// Enter new state
@@ -152,7 +371,7 @@ void ADrone::UpdateCurrentState()
 	{
 	case EDroneState::Patrolling:
 		{
-			if (DetectedPlayer && bPlayerInSight && !bSafeZoneActive)
+			if (DetectedPlayer && bPlayerInSight && !IsPlayerInSafeZone(DetectedPlayer) && !ShouldGiveUpChase(DetectedPlayer))
 			{
 				StartChasing(DetectedPlayer);
 			}
@@ -174,7 +393,7 @@ void ADrone::UpdateCurrentState()
 
 	case EDroneState::Chasing:
 		{
-			if (bSafeZoneActive)
+			if (IsPlayerInSafeZone(DetectedPlayer))
 			{
 				ForceEndChase();
 			}
@@ -185,9 +404,13 @@ void ADrone::UpdateCurrentState()
 				{
 					GrabPlayer(DetectedPlayer);
 				}
+				else if (ShouldGiveUpChase(DetectedPlayer))
+				{
+					LosePlayer();
+				}
 				else
 				{
-					MoveToLocation(DetectedPlayer->GetActorLocation(), ChaseSpeed);
+					MoveToLocation(GetChaseTarget(DetectedPlayer), ChaseSpeed);
 				}
 			}
 			else
@@ -197,6 +420,14 @@ void ADrone::UpdateCurrentState()
 				{
 					StartLosePlayerTimer();
 				}
+
+				// Meanwhile head for where the squad last saw them
+				const UDronePerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UDronePerceptionSubsystem>();
+				const FPlayerPerception* PlayerPerception = Perception ? Perception->FindPerception(DetectedPlayer) : nullptr;
+				if (PlayerPerception && PlayerPerception->LastSeenTime >= 0.0)
+				{
+					MoveToLocation(PlayerPerception->LastKnownLocation, ChaseSpeed);
+				}
 			}
 		}
 		break;
@@ -240,15 +471,39 @@ void ADrone::UpdateCurrentState()
 // Movement Functions
 void ADrone::MoveToLocation(const FVector& Location, float Speed)
 {
+	UDroneAvoidanceSubsystem* Avoidance = GetWorld()->GetSubsystem<UDroneAvoidanceSubsystem>();
+	const float AvoidanceWeight = CurrentState == EDroneState::Carrying ? CarryingAvoidanceWeight : 1.0f;
+
+	if (bUseFixedStep)
+	{
+		// Kinematic move at full speed, the movement component's acceleration is frame-rate dependent
+		const FRotator TargetRotation = UKismetMathLibrary::FindLookAtRotation(SimLocation, Location);
+		FVector Velocity = (Location - SimLocation).GetClampedToMaxSize(Speed * SimDeltaSeconds) / FMath::Max(SimDeltaSeconds, UE_KINDA_SMALL_NUMBER);
+		if (Avoidance)
+		{
+			Velocity = Avoidance->AdjustVelocity(this, Velocity, Speed, AvoidanceWeight);
+		}
+		SimRotation = FMath::RInterpTo(SimRotation, TargetRotation, SimDeltaSeconds, 2.0f);
+
+		// Swept like the movement component would, the simulated pose stops where the drone hit something
+		SetActorLocationAndRotation(SimLocation + Velocity * SimDeltaSeconds, SimRotation, true);
+		SimLocation = GetActorLocation();
+		return;
+	}
+
 	if (FloatingMovement)
 	{
 		FloatingMovement->MaxSpeed = Speed;
 		FVector Direction = (Location - GetActorLocation()).GetSafeNormal();
+		if (Avoidance && Speed > 0.0f)
+		{
+			Direction = Avoidance->AdjustVelocity(this, Direction * Speed, Speed, AvoidanceWeight) / Speed;
+		}
 		FloatingMovement->AddInputVector(Direction);
 
 		// Rotate to face movement direction
 		FRotator TargetRotation = UKismetMathLibrary::FindLookAtRotation(GetActorLocation(), Location);
-		SetActorRotation(FMath::RInterpTo(GetActorRotation(), TargetRotation, GetWorld()->GetDeltaSeconds(), 2.0f));
+		SetActorRotation(FMath::RInterpTo(GetActorRotation(), TargetRotation, SimDeltaSeconds, 2.0f));
 	}
 }
 
@@ -276,6 +531,95 @@ void ADrone::EndPatrolWait()
 	SetNewPatrolTarget();
 }
 
+// Dormancy
+void ADrone::EnterDormancy()
+{
+	SetActorTickEnabled(false);
+	FloatingMovement->StopMovementImmediately();
+	FloatingMovement->SetComponentTickEnabled(false);
+	GetWorldTimerManager().PauseTimer(PatrolTimer);
+}
+
+void ADrone::ExitDormancy(float DormantSeconds)
+{
+	SetActorTickEnabled(true);
+	FloatingMovement->SetComponentTickEnabled(!bUseFixedStep);
+
+	CatchUpPatrol(DormantSeconds);
+}
+
+void ADrone::CatchUpPatrol(float Seconds)
+{
+	FTimerManager& TimerManager = GetWorldTimerManager();
+	if (PatrolPoints.IsEmpty() || PatrolSpeed <= 0.0f)
+	{
+		TimerManager.UnPauseTimer(PatrolTimer);
+		return;
+	}
+
+	// Finish the wait the drone fell asleep in
+	if (bIsWaitingAtPatrol)
+	{
+		const float Remaining = TimerManager.GetTimerRemaining(PatrolTimer);
+		if (Seconds < Remaining)
+		{
+			TimerManager.SetTimer(PatrolTimer, this, &ADrone::EndPatrolWait, Remaining - Seconds, false);
+			return;
+		}
+
+		Seconds -= Remaining;
+		TimerManager.ClearTimer(PatrolTimer);
+		EndPatrolWait();
+	}
+
+	// Time for one full loop of the route, so whole loops can be skipped
+	float LoopSeconds = 0.0f;
+	for (int32 Index = 0; Index < PatrolPoints.Num(); ++Index)
+	{
+		const ATargetPoint* From = PatrolPoints[Index];
+		const ATargetPoint* To = PatrolPoints[(Index + 1) % PatrolPoints.Num()];
+		if (From && To)
+		{
+			LoopSeconds += FVector::Dist(From->GetActorLocation(), To->GetActorLocation()) / PatrolSpeed + PatrolWaitTime;
+		}
+	}
+
+	FVector Location = GetActorLocation();
+	bool bSkippedLoops = false;
+
+	// Each step travels to the current target then waits there. Bounded to one loop plus the first leg.
+	for (int32 Step = 0; Step <= PatrolPoints.Num() + 1; ++Step)
+	{
+		const float TravelSeconds = FVector::Dist(Location, CurrentTarget) / PatrolSpeed;
+		if (Seconds < TravelSeconds)
+		{
+			Location += (CurrentTarget - Location).GetSafeNormal() * Seconds * PatrolSpeed;
+			break;
+		}
+
+		Seconds -= TravelSeconds;
+		Location = CurrentTarget;
+
+		if (!bSkippedLoops && LoopSeconds > 0.0f)
+		{
+			Seconds = FMath::Fmod(Seconds, LoopSeconds);
+			bSkippedLoops = true;
+		}
+
+		if (Seconds < PatrolWaitTime)
+		{
+			bIsWaitingAtPatrol = true;
+			TimerManager.SetTimer(PatrolTimer, this, &ADrone::EndPatrolWait, PatrolWaitTime - Seconds, false);
+			break;
+		}
+
+		Seconds -= PatrolWaitTime;
+		SetNewPatrolTarget();
+	}
+
+	SetActorLocation(Location);
+}
+
 // Detection Functions
 bool ADrone::CanSeePlayer(ABoxCharacter* Player)
 {
@@ -284,6 +628,12 @@ bool ADrone::CanSeePlayer(ABoxCharacter* Player)
 	// Check if player is in sight cone
 	if (!IsPlayerInSightCone(Player)) return false;
 
+	// The squad blackboard shares sightings and budgets the traces
+	if (UDronePerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UDronePerceptionSubsystem>())
+	{
+		return Perception->QuerySight(this, Player);
+	}
+
 	// Perform line trace to check for obstacles
 	FVector Start = GetActorLocation();
 	FVector End = Player->GetActorLocation();
@@ -293,6 +643,7 @@ bool ADrone::CanSeePlayer(ABoxCharacter* Player)
 	QueryParams.AddIgnoredActor(this);
 	QueryParams.bTraceComplex = false;
 
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::LineTraces);
 	bool bHit = GetWorld()->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, QueryParams);
 
 	// If we hit something, check if it's the player
@@ -344,6 +695,148 @@ void ADrone::ClearLosePlayerTimer()
 	GetWorld()->GetTimerManager().ClearTimer(LosePlayerTimer);
 }
 
+// Target Selection
+void ADrone::AddTargetCandidate(ABoxCharacter* Player)
+{
+	TargetCandidates.RemoveAll([](const TWeakObjectPtr<ABoxCharacter>& Candidate) { return !Candidate.IsValid(); });
+	if (TargetCandidates.Contains(Player))
+	{
+		return;
+	}
+
+	if (TargetCandidates.Num() < MaxTargetCandidates)
+	{
+		TargetCandidates.Add(Player);
+		return;
+	}
+
+	// Full: the new player replaces the farthest candidate if it is closer
+	const FVector Location = GetActorLocation();
+	int32 FarthestIndex = 0;
+	for (int32 Index = 1; Index < TargetCandidates.Num(); ++Index)
+	{
+		if (FVector::DistSquared(TargetCandidates[Index]->GetActorLocation(), Location) > FVector::DistSquared(TargetCandidates[FarthestIndex]->GetActorLocation(), Location))
+		{
+			FarthestIndex = Index;
+		}
+	}
+
+	if (FVector::DistSquared(Player->GetActorLocation(), Location) < FVector::DistSquared(TargetCandidates[FarthestIndex]->GetActorLocation(), Location))
+	{
+		TargetCandidates[FarthestIndex] = Player;
+	}
+}
+
+float ADrone::ScoreTarget(const ABoxCharacter* Player) const
+{
+	const FVector ToPlayer = Player->GetActorLocation() - GetActorLocation();
+	const float DistanceScore = 1.0f - FMath::Clamp(ToPlayer.Size() / FMath::Max(DetectionRadius, 1.0f), 0.0f, 1.0f);
+	const float AlignmentScore = (FVector::DotProduct(GetActorForwardVector(), ToPlayer.GetSafeNormal()) + 1.0f) * 0.5f;
+
+	float SightScore = 0.0f;
+	const UDronePerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UDronePerceptionSubsystem>();
+	const FPlayerPerception* PlayerPerception = Perception ? Perception->FindPerception(Player) : nullptr;
+	if (PlayerPerception && PlayerPerception->LastSeenTime >= 0.0 && LosePlayerTime > 0.0f)
+	{
+		const float SeenAge = GetWorld()->GetTimeSeconds() - PlayerPerception->LastSeenTime;
+		SightScore = 1.0f - FMath::Clamp(SeenAge / LosePlayerTime, 0.0f, 1.0f);
+	}
+
+	return DistanceScore * DistanceWeight + AlignmentScore * AlignmentWeight + SightScore * RecentSightWeight;
+}
+
+void ADrone::SelectTarget()
+{
+	ABoxCharacter* BestPlayer = nullptr;
+	float BestScore = 0.0f;
+	float CurrentScore = -1.0f;
+
+	for (const TWeakObjectPtr<ABoxCharacter>& Candidate : TargetCandidates)
+	{
+		ABoxCharacter* Player = Candidate.Get();
+		if (!Player || IsPlayerInSafeZone(Player))
+		{
+			continue;
+		}
+
+		const float Score = ScoreTarget(Player);
+		if (Player == DetectedPlayer)
+		{
+			CurrentScore = Score;
+		}
+
+		// Ties go to the lower object id, so the choice does not depend on overlap order
+		if (!BestPlayer || Score > BestScore || (Score == BestScore && Player->GetUniqueID() < BestPlayer->GetUniqueID()))
+		{
+			BestPlayer = Player;
+			BestScore = Score;
+		}
+	}
+
+	// Stick with the current target unless the best one is clearly better
+	if (BestPlayer && BestPlayer != DetectedPlayer && (CurrentScore < 0.0f || BestScore > CurrentScore + TargetSwitchMargin))
+	{
+		DetectedPlayer = BestPlayer;
+		bPlayerInSight = false;
+	}
+}
+
+// Safe Zones
+bool ADrone::IsPlayerInSafeZone(ABoxCharacter* Player) const
+{
+	const USafeZoneSubsystem* SafeZones = GetWorld()->GetSubsystem<USafeZoneSubsystem>();
+	return Player && SafeZones && SafeZones->IsPlayerSafe(Player);
+}
+
+void ADrone::OnPlayerSafeStateChanged(ABoxCharacter* Player, bool bIsSafe)
+{
+	if (bIsSafe && CurrentState == EDroneState::Chasing && Player == DetectedPlayer)
+	{
+		ForceEndChase();
+	}
+}
+
+bool ADrone::ShouldGiveUpChase(ABoxCharacter* Player) const
+{
+	if (!bUseSafeZoneField || !Player || ChaseSpeed <= 0.0f) return false;
+
+	const FVector PlayerLocation = Player->GetActorLocation();
+	const USafeZoneSubsystem* SafeZones = GetWorld()->GetSubsystem<USafeZoneSubsystem>();
+	const ASafeZoneField* Field = SafeZones ? SafeZones->FindField(PlayerLocation) : nullptr;
+	if (!Field) return false;
+
+	const float SafeDistance = Field->GetSafeZoneDistance(PlayerLocation);
+	if (SafeDistance < 0.0f) return false;
+
+	// Only a player heading for the safe zone can make it there
+	const float SpeedTowardsSafety = FVector::DotProduct(Player->GetVelocity(), Field->GetDirectionToSafeZone(PlayerLocation));
+	if (SpeedTowardsSafety <= KINDA_SMALL_NUMBER) return false;
+
+	const float PlayerTimeToSafety = SafeDistance / SpeedTowardsSafety;
+	const float DroneTimeToPlayer = FMath::Max(0.0f, FVector::Dist(GetActorLocation(), PlayerLocation) - InteractionRadius) / ChaseSpeed;
+	return PlayerTimeToSafety < DroneTimeToPlayer;
+}
+
+FVector ADrone::GetChaseTarget(ABoxCharacter* Player) const
+{
+	const FVector PlayerLocation = Player->GetActorLocation();
+	if (!bUseSafeZoneField) return PlayerLocation;
+
+	const USafeZoneSubsystem* SafeZones = GetWorld()->GetSubsystem<USafeZoneSubsystem>();
+	const ASafeZoneField* Field = SafeZones ? SafeZones->FindField(PlayerLocation) : nullptr;
+	if (!Field) return PlayerLocation;
+
+	const float SafeDistance = Field->GetSafeZoneDistance(PlayerLocation);
+	if (SafeDistance < 0.0f || SafeDistance > InterceptRange) return PlayerLocation;
+
+	const float CoverDistance = Field->GetCoverDistance(PlayerLocation);
+	if (CoverDistance >= 0.0f && CoverDistance < FMath::Min(CoverChaseDistance, SafeDistance)) return PlayerLocation;
+
+	// Aim between the player and the safe zone to cut them off
+	const float Lead = FMath::Min(SafeDistance, FVector::Dist(GetActorLocation(), PlayerLocation) * 0.5f);
+	return PlayerLocation + Field->GetDirectionToSafeZone(PlayerLocation) * Lead;
+}
+
 // Player Interaction
 void ADrone::GrabPlayer(ABoxCharacter* Player)
 {
@@ -352,10 +845,13 @@ void ADrone::GrabPlayer(ABoxCharacter* Player)
 		CarriedPlayer = Player;
 
 		// Damage the player when captured
-		Player->ReceiveDamage(30);
+		if (UDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UDamageSubsystem>())
+		{
+			DamageSubsystem->QueueDamage(Player, EDamageKind::DroneGrab, this);
+		}
 		
-		// Attach player to drone
-		Player->AttachToActor(this, FAttachmentTransformRules::KeepWorldTransform);
+		// The player follows the drone without simulating its own movement
+		Player->BeginCarried(DroneMesh, CarrySocket);
 		
 		// Disable player input
 		if (APlayerController* PC = Player->GetController<APlayerController>())
@@ -379,9 +875,8 @@ void ADrone::DropPlayer()
 		// Calculate drop position at DropOffPoint + DropOffHeight
 		FVector DropLocation = DropOffPoint->GetActorLocation() + FVector(0, 0, DropOffHeight);
 
-		// Detach player
-		CarriedPlayer->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
-		CarriedPlayer->SetActorLocation(DropLocation);
+		// Detach player at a free spot around the drop location
+		CarriedPlayer->EndCarried(DropLocation);
 
 		// Re-enable player input
 		if (APlayerController* PC = CarriedPlayer->GetController<APlayerController>())
@@ -414,9 +909,11 @@ void ADrone::CarryPlayerToDropOff()
 // Overlap Events
 void ADrone::OnDetectionSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::OverlapEvents);
+
 	if (ABoxCharacter* Player = Cast<ABoxCharacter>(OtherActor))
 	{
-		DetectedPlayer = Player;
+		AddTargetCandidate(Player);
 		
 		if (GEngine)
 		{
@@ -427,8 +924,12 @@ void ADrone::OnDetectionSphereBeginOverlap(UPrimitiveComponent* OverlappedCompon
 
 void ADrone::OnDetectionSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
 {
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::OverlapEvents);
+
 	if (ABoxCharacter* Player = Cast<ABoxCharacter>(OtherActor))
 	{
+		TargetCandidates.Remove(Player);
+
 		if (DetectedPlayer == Player)
 		{
 			bPlayerInSight = false;
@@ -438,6 +939,8 @@ void ADrone::OnDetectionSphereEndOverlap(UPrimitiveComponent* OverlappedComponen
 
 void ADrone::OnInteractionSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::OverlapEvents);
+
 	if (ABoxCharacter* Player = Cast<ABoxCharacter>(OtherActor))
 	{
 		if (CurrentState == EDroneState::Chasing && Player == DetectedPlayer)
@@ -468,7 +971,6 @@ void ADrone::ForceEndChase()
 {
 	DetectedPlayer = nullptr;
 	bPlayerInSight = false;
-	bSafeZoneActive = true;
 	ChangeState(EDroneState::Returning);
 	if (GEngine)
 	{
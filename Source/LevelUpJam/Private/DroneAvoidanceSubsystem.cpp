@@ -0,0 +1,493 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DroneAvoidanceSubsystem.h"
+#include "Drone.h"
+#include "FixedStepSubsystem.h"
+#include "LevelUpJam.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Drone Avoidance"), STAT_DroneAvoidance, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Drones Avoiding"), STAT_DronesAvoiding, STATGROUP_LevelUpJam);
+
+namespace DroneAvoidance
+{
+	// Below this many agents the solve is not worth spreading over worker threads
+	constexpr int32 MinParallelAgents = 64;
+
+	// Half-plane of permitted velocities: the left side of Direction through Point
+	struct FOrcaLine
+	{
+		FVector2D Point;
+		FVector2D Direction;
+	};
+
+	using FLineArray = TArray<FOrcaLine, TInlineAllocator<16>>;
+
+	float Det(const FVector2D& A, const FVector2D& B)
+	{
+		return A.X * B.Y - A.Y * B.X;
+	}
+
+	// Linear programs from the reference ORCA implementation (van den Berg et al., RVO2):
+	// finds the velocity closest to OptVelocity inside every line and the speed circle.
+
+	bool LinearProgram1(TConstArrayView<FOrcaLine> Lines, int32 LineNo, float Radius, const FVector2D& OptVelocity, bool bDirectionOpt, FVector2D& Result)
+	{
+		const FOrcaLine& Line = Lines[LineNo];
+		const float DotProduct = Line.Point | Line.Direction;
+		const float Discriminant = FMath::Square(DotProduct) + FMath::Square(Radius) - Line.Point.SizeSquared();
+		if (Discriminant < 0.0f)
+		{
+			// The speed circle does not reach the line
+			return false;
+		}
+
+		const float SqrtDiscriminant = FMath::Sqrt(Discriminant);
+		float TLeft = -DotProduct - SqrtDiscriminant;
+		float TRight = -DotProduct + SqrtDiscriminant;
+
+		for (int32 Index = 0; Index < LineNo; ++Index)
+		{
+			const float Denominator = Det(Line.Direction, Lines[Index].Direction);
+			const float Numerator = Det(Lines[Index].Direction, Line.Point - Lines[Index].Point);
+
+			if (FMath::Abs(Denominator) <= UE_KINDA_SMALL_NUMBER)
+			{
+				// Parallel lines
+				if (Numerator < 0.0f)
+				{
+					return false;
+				}
+				continue;
+			}
+
+			const float T = Numerator / Denominator;
+			if (Denominator >= 0.0f)
+			{
+				TRight = FMath::Min(TRight, T);
+			}
+			else
+			{
+				TLeft = FMath::Max(TLeft, T);
+			}
+
+			if (TLeft > TRight)
+			{
+				return false;
+			}
+		}
+
+		if (bDirectionOpt)
+		{
+			Result = Line.Point + ((OptVelocity | Line.Direction) > 0.0f ? TRight : TLeft) * Line.Direction;
+		}
+		else
+		{
+			const float T = Line.Direction | (OptVelocity - Line.Point);
+			Result = Line.Point + FMath::Clamp(T, TLeft, TRight) * Line.Direction;
+		}
+		return true;
+	}
+
+	// Returns the number of lines satisfied, Lines.Num() on success
+	int32 LinearProgram2(TConstArrayView<FOrcaLine> Lines, float Radius, const FVector2D& OptVelocity, bool bDirectionOpt, FVector2D& Result)
+	{
+		if (bDirectionOpt)
+		{
+			Result = OptVelocity * Radius;
+		}
+		else if (OptVelocity.SizeSquared() > FMath::Square(Radius))
+		{
+			Result = OptVelocity.GetSafeNormal() * Radius;
+		}
+		else
+		{
+			Result = OptVelocity;
+		}
+
+		for (int32 Index = 0; Index < Lines.Num(); ++Index)
+		{
+			if (Det(Lines[Index].Direction, Lines[Index].Point - Result) > 0.0f)
+			{
+				const FVector2D PreviousResult = Result;
+				if (!LinearProgram1(Lines, Index, Radius, OptVelocity, bDirectionOpt, Result))
+				{
+					Result = PreviousResult;
+					return Index;
+				}
+			}
+		}
+		return Lines.Num();
+	}
+
+	// Infeasible: minimizes the largest violation instead, starting from the first failing line
+	void LinearProgram3(TConstArrayView<FOrcaLine> Lines, int32 BeginLine, float Radius, FVector2D& Result)
+	{
+		float Distance = 0.0f;
+
+		for (int32 Index = BeginLine; Index < Lines.Num(); ++Index)
+		{
+			const FOrcaLine& Line = Lines[Index];
+			if (Det(Line.Direction, Line.Point - Result) <= Distance)
+			{
+				continue;
+			}
+
+			FLineArray ProjectedLines;
+			for (int32 Other = 0; Other < Index; ++Other)
+			{
+				FOrcaLine Projected;
+				const float Determinant = Det(Line.Direction, Lines[Other].Direction);
+				if (FMath::Abs(Determinant) <= UE_KINDA_SMALL_NUMBER)
+				{
+					if ((Line.Direction | Lines[Other].Direction) > 0.0f)
+					{
+						// Same direction
+						continue;
+					}
+					Projected.Point = 0.5f * (Line.Point + Lines[Other].Point);
+				}
+				else
+				{
+					Projected.Point = Line.Point + (Det(Lines[Other].Direction, Line.Point - Lines[Other].Point) / Determinant) * Line.Direction;
+				}
+				Projected.Direction = (Lines[Other].Direction - Line.Direction).GetSafeNormal();
+				ProjectedLines.Add(Projected);
+			}
+
+			const FVector2D PreviousResult = Result;
+			if (LinearProgram2(ProjectedLines, Radius, FVector2D(-Line.Direction.Y, Line.Direction.X), true, Result) < ProjectedLines.Num())
+			{
+				// Can only fail from rounding, the previous result is still the best one
+				Result = PreviousResult;
+			}
+			Distance = Det(Line.Direction, Line.Point - Result);
+		}
+	}
+}
+
+void UDroneAvoidanceSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Bound before any drone begins play, so each step solves ahead of the drones' own steps
+	UFixedStepSubsystem* FixedStep = InWorld.GetSubsystem<UFixedStepSubsystem>();
+	if (FixedStep && FixedStep->IsEnabled())
+	{
+		bUseFixedStep = true;
+		FixedStepHandle = FixedStep->OnFixedStep.AddUObject(this, &UDroneAvoidanceSubsystem::Solve);
+	}
+}
+
+void UDroneAvoidanceSubsystem::Deinitialize()
+{
+	if (UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>())
+	{
+		FixedStep->OnFixedStep.Remove(FixedStepHandle);
+	}
+
+	Agents.Reset();
+	AgentIndices.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId UDroneAvoidanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDroneAvoidanceSubsystem, STATGROUP_Tickables);
+}
+
+void UDroneAvoidanceSubsystem::RegisterDrone(ADrone* Drone, float Radius)
+{
+	if (!Drone || AgentIndices.Contains(Drone))
+	{
+		return;
+	}
+
+	FAgent& Agent = Agents.AddDefaulted_GetRef();
+	Agent.Drone = Drone;
+	Agent.Radius = Radius;
+	AgentIndices.Add(Drone, Agents.Num() - 1);
+}
+
+void UDroneAvoidanceSubsystem::UnregisterDrone(ADrone* Drone)
+{
+	int32 Index = INDEX_NONE;
+	if (!AgentIndices.RemoveAndCopyValue(Drone, Index))
+	{
+		return;
+	}
+
+	Agents.RemoveAtSwap(Index, EAllowShrinking::No);
+	if (Agents.IsValidIndex(Index))
+	{
+		AgentIndices.Add(Agents[Index].Drone, Index);
+	}
+}
+
+FVector UDroneAvoidanceSubsystem::AdjustVelocity(const ADrone* Drone, const FVector& PreferredVelocity, float MaxSpeed, float Weight)
+{
+	const int32* Index = bEnabled ? AgentIndices.Find(Drone) : nullptr;
+	if (!Index)
+	{
+		return PreferredVelocity;
+	}
+
+	FAgent& Agent = Agents[*Index];
+	Agent.PreferredVelocity = PreferredVelocity;
+	Agent.MaxSpeed = MaxSpeed;
+	Agent.Weight = Weight;
+
+	// The solve is a frame old; when it did not have to steer, the current preference is better.
+	// Height is not avoided and keeps the preferred climb rate.
+	Agent.AppliedVelocity = Agent.bAvoiding
+		? FVector(Agent.SolvedVelocity.X, Agent.SolvedVelocity.Y, PreferredVelocity.Z)
+		: PreferredVelocity;
+	return Agent.AppliedVelocity;
+}
+
+void UDroneAvoidanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!bUseFixedStep)
+	{
+		Solve(DeltaTime);
+	}
+}
+
+void UDroneAvoidanceSubsystem::Solve(float StepSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DroneAvoidance);
+
+	for (int32 Index = Agents.Num() - 1; Index >= 0; --Index)
+	{
+		if (!Agents[Index].Drone.IsValid())
+		{
+			AgentIndices.Remove(Agents[Index].Drone);
+			Agents.RemoveAtSwap(Index, EAllowShrinking::No);
+			if (Agents.IsValidIndex(Index))
+			{
+				AgentIndices.Add(Agents[Index].Drone, Index);
+			}
+		}
+	}
+
+	if (!bEnabled || Agents.IsEmpty())
+	{
+		return;
+	}
+
+	States.SetNum(Agents.Num(), EAllowShrinking::No);
+	for (int32 Index = 0; Index < Agents.Num(); ++Index)
+	{
+		const FAgent& Agent = Agents[Index];
+		FAgentState& State = States[Index];
+		State.Location = Agent.Drone->GetSimulatedLocation();
+		State.Velocity = FVector2D(Agent.AppliedVelocity);
+		State.PreferredVelocity = FVector2D(Agent.PreferredVelocity);
+		State.Radius = Agent.Radius;
+		State.Weight = Agent.Weight;
+		State.MaxSpeed = Agent.MaxSpeed;
+	}
+
+	BuildGrid();
+
+	const float SolveSeconds = FMath::Max(StepSeconds, UE_KINDA_SMALL_NUMBER);
+	NewVelocities.SetNum(Agents.Num(), EAllowShrinking::No);
+	ParallelFor(Agents.Num(), [this, SolveSeconds](int32 Index)
+	{
+		NewVelocities[Index] = SolveAgent(Index, SolveSeconds);
+	}, Agents.Num() < DroneAvoidance::MinParallelAgents ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	int32 NumAvoiding = 0;
+	for (int32 Index = 0; Index < Agents.Num(); ++Index)
+	{
+		FAgent& Agent = Agents[Index];
+		Agent.SolvedVelocity = NewVelocities[Index];
+		Agent.bAvoiding = !NewVelocities[Index].Equals(States[Index].PreferredVelocity, 1.0f);
+		Agent.PreferredVelocity = FVector::ZeroVector;
+		Agent.AppliedVelocity = FVector::ZeroVector;
+		NumAvoiding += Agent.bAvoiding;
+	}
+
+	SET_DWORD_STAT(STAT_DronesAvoiding, NumAvoiding);
+	CSV_CUSTOM_STAT(LevelUpJam, DronesAvoiding, NumAvoiding, ECsvCustomStatOp::Set);
+}
+
+void UDroneAvoidanceSubsystem::BuildGrid()
+{
+	// Agents sorted by cell, then each cell maps to its range of the sorted array
+	CellAgents.Reset();
+	for (int32 Index = 0; Index < States.Num(); ++Index)
+	{
+		const FVector& Location = States[Index].Location;
+		CellAgents.Emplace(FIntPoint(FMath::FloorToInt32(Location.X / NeighbourDistance), FMath::FloorToInt32(Location.Y / NeighbourDistance)), Index);
+	}
+
+	CellAgents.Sort([](const TPair<FIntPoint, int32>& A, const TPair<FIntPoint, int32>& B)
+	{
+		return A.Key.X != B.Key.X ? A.Key.X < B.Key.X : A.Key.Y < B.Key.Y;
+	});
+
+	CellRanges.Reset();
+	for (int32 Start = 0; Start < CellAgents.Num();)
+	{
+		int32 End = Start + 1;
+		while (End < CellAgents.Num() && CellAgents[End].Key == CellAgents[Start].Key)
+		{
+			++End;
+		}
+		CellRanges.Add(CellAgents[Start].Key, FIntPoint(Start, End - Start));
+		Start = End;
+	}
+}
+
+FVector2D UDroneAvoidanceSubsystem::SolveAgent(int32 Index, float StepSeconds) const
+{
+	using namespace DroneAvoidance;
+
+	const FAgentState& Self = States[Index];
+	if (Self.MaxSpeed <= 0.0f)
+	{
+		return Self.PreferredVelocity;
+	}
+
+	// Closest neighbours from the 3x3 cells around the agent
+	TArray<TPair<float, int32>, TInlineAllocator<16>> Neighbours;
+	const FIntPoint Cell(FMath::FloorToInt32(Self.Location.X / NeighbourDistance), FMath::FloorToInt32(Self.Location.Y / NeighbourDistance));
+	const float MaxDistSq = FMath::Square(NeighbourDistance);
+
+	for (int32 Y = -1; Y <= 1; ++Y)
+	{
+		for (int32 X = -1; X <= 1; ++X)
+		{
+			const FIntPoint* Range = CellRanges.Find(Cell + FIntPoint(X, Y));
+			for (int32 Slot = Range ? Range->X : 0; Range && Slot < Range->X + Range->Y; ++Slot)
+			{
+				const int32 Other = CellAgents[Slot].Value;
+				const FAgentState& OtherState = States[Other];
+
+				// Drones far above or below pass each other
+				const float CombinedRadius = Self.Radius + OtherState.Radius;
+				if (Other == Index || FMath::Abs(OtherState.Location.Z - Self.Location.Z) > CombinedRadius * 2.0f)
+				{
+					continue;
+				}
+
+				const float DistSq = FVector2D::DistSquared(FVector2D(Self.Location), FVector2D(OtherState.Location));
+				if (DistSq >= MaxDistSq)
+				{
+					continue;
+				}
+
+				if (Neighbours.Num() < MaxNeighbours)
+				{
+					Neighbours.Emplace(DistSq, Other);
+				}
+				else if (DistSq < Neighbours.Last().Key)
+				{
+					Neighbours.Last() = TPair<float, int32>(DistSq, Other);
+				}
+				else
+				{
+					continue;
+				}
+
+				// Keep the list sorted by distance so the farthest is last
+				for (int32 Sorted = Neighbours.Num() - 1; Sorted > 0 && Neighbours[Sorted].Key < Neighbours[Sorted - 1].Key; --Sorted)
+				{
+					Swap(Neighbours[Sorted], Neighbours[Sorted - 1]);
+				}
+			}
+		}
+	}
+
+	if (Neighbours.IsEmpty())
+	{
+		return Self.PreferredVelocity;
+	}
+
+	const float InvTimeHorizon = 1.0f / FMath::Max(TimeHorizon, UE_KINDA_SMALL_NUMBER);
+	const float InvStepSeconds = 1.0f / StepSeconds;
+
+	FLineArray Lines;
+	for (const TPair<float, int32>& Neighbour : Neighbours)
+	{
+		const FAgentState& Other = States[Neighbour.Value];
+		const FVector2D RelativePosition = FVector2D(Other.Location - Self.Location);
+		const FVector2D RelativeVelocity = Self.Velocity - Other.Velocity;
+		const float DistSq = Neighbour.Key;
+		const float CombinedRadius = Self.Radius + Other.Radius;
+		const float CombinedRadiusSq = FMath::Square(CombinedRadius);
+
+		FOrcaLine Line;
+		FVector2D U;
+
+		if (DistSq > CombinedRadiusSq)
+		{
+			// No collision yet: leave the velocity obstacle truncated at the time horizon
+			const FVector2D W = RelativeVelocity - InvTimeHorizon * RelativePosition;
+			const float WLengthSq = W.SizeSquared();
+			const float DotProduct = W | RelativePosition;
+
+			if (DotProduct < 0.0f && FMath::Square(DotProduct) > CombinedRadiusSq * WLengthSq)
+			{
+				// Closest to the cut-off circle
+				const float WLength = FMath::Sqrt(WLengthSq);
+				const FVector2D UnitW = W / WLength;
+				Line.Direction = FVector2D(UnitW.Y, -UnitW.X);
+				U = (CombinedRadius * InvTimeHorizon - WLength) * UnitW;
+			}
+			else
+			{
+				// Closest to one of the legs
+				const float Leg = FMath::Sqrt(DistSq - CombinedRadiusSq);
+				if (Det(RelativePosition, W) > 0.0f)
+				{
+					Line.Direction = FVector2D(RelativePosition.X * Leg - RelativePosition.Y * CombinedRadius, RelativePosition.X * CombinedRadius + RelativePosition.Y * Leg) / DistSq;
+				}
+				else
+				{
+					Line.Direction = -FVector2D(RelativePosition.X * Leg + RelativePosition.Y * CombinedRadius, -RelativePosition.X * CombinedRadius + RelativePosition.Y * Leg) / DistSq;
+				}
+				U = (RelativeVelocity | Line.Direction) * Line.Direction - RelativeVelocity;
+			}
+		}
+		else
+		{
+			// Already overlapping: get apart within this step
+			const FVector2D W = RelativeVelocity - InvStepSeconds * RelativePosition;
+			const float WLength = FMath::Max(W.Size(), UE_KINDA_SMALL_NUMBER);
+			const FVector2D UnitW = W / WLength;
+			Line.Direction = FVector2D(UnitW.Y, -UnitW.X);
+			U = (CombinedRadius * InvStepSeconds - WLength) * UnitW;
+		}
+
+		// Reciprocal: each side takes its share of the avoidance, half between equals
+		const float WeightSum = Self.Weight + Other.Weight;
+		const float Share = WeightSum > 0.0f ? Self.Weight / WeightSum : 0.5f;
+		Line.Point = Self.Velocity + Share * U;
+		Lines.Add(Line);
+	}
+
+	FVector2D Result;
+	const int32 LineFail = LinearProgram2(Lines, Self.MaxSpeed, Self.PreferredVelocity, false, Result);
+	if (LineFail < Lines.Num())
+	{
+		LinearProgram3(Lines, LineFail, Self.MaxSpeed, Result);
+	}
+	return Result;
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GAvoidanceEnableCommand(
+	TEXT("LevelUpJam.Avoidance.Enable"),
+	TEXT("Enable or disable drone to drone avoidance. Usage: LevelUpJam.Avoidance.Enable 0|1"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UDroneAvoidanceSubsystem* Avoidance = World ? World->GetSubsystem<UDroneAvoidanceSubsystem>() : nullptr)
+		{
+			Avoidance->SetEnabled(Args.Num() == 0 || FCString::Atoi(*Args[0]) != 0);
+		}
+	}));
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DronePerceptionSubsystem.h"
+#include "BoxCharacter.h"
+#include "Drone.h"
+#include "DroneVisibilityVolume.h"
+#include "LevelUpJam.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Drone Perception Traces"), STAT_DronePerceptionTraces, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Traces"), STAT_PerceptionTraces, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Shared Sightings"), STAT_PerceptionShared, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Deferred Traces"), STAT_PerceptionDeferred, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception PVS Rejections"), STAT_PerceptionPVSRejected, STATGROUP_LevelUpJam);
+
+void UDronePerceptionSubsystem::Deinitialize()
+{
+	Blackboard.Reset();
+	Requests.Reset();
+	VisibilityVolumes.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId UDronePerceptionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDronePerceptionSubsystem, STATGROUP_Tickables);
+}
+
+bool UDronePerceptionSubsystem::QuerySight(const ADrone* Drone, const ABoxCharacter* Player)
+{
+	FPlayerPerception& Perception = Blackboard.FindOrAdd(Player);
+	FPlayerPerception::FDroneSight& Sight = Perception.Drones.FindOrAdd(Drone);
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// Static walls in between, no trace or shared sighting can change that
+	if (IsHiddenByVisibilitySet(Drone->GetActorLocation(), Player->GetActorLocation()))
+	{
+		INC_DWORD_STAT(STAT_PerceptionPVSRejected);
+		Sight.bVisible = false;
+		Sight.TraceTime = Now;
+		return false;
+	}
+
+	// A drone trusts the squad's sighting unless its own trace since then found a wall in the way
+	const bool bFreshSighting = SharedSightMaxAge > 0.0f && Perception.LastSeenTime >= Now - SharedSightMaxAge;
+	const bool bOwnTraceIsNewer = Sight.TraceTime > Perception.LastSeenTime && !Sight.bVisible;
+	const bool bTrustShared = bFreshSighting && Perception.LastSeenBy != Drone && !bOwnTraceIsNewer;
+	if (bTrustShared)
+	{
+		INC_DWORD_STAT(STAT_PerceptionShared);
+
+		// The squad may see the player from the other side of a wall, check for ourselves now and then
+		if (Now - Sight.TraceTime < OwnTraceMaxAge)
+		{
+			return true;
+		}
+	}
+
+	if (!Requests.ContainsByPredicate([Drone, Player](const FSightRequest& Request) { return Request.Drone == Drone && Request.Player == Player; }))
+	{
+		Requests.Add({ Drone, Player, Sight.TraceTime });
+	}
+	return bTrustShared || Sight.bVisible;
+}
+
+void UDronePerceptionSubsystem::RegisterVisibilityVolume(ADroneVisibilityVolume* Volume)
+{
+	VisibilityVolumes.AddUnique(Volume);
+}
+
+void UDronePerceptionSubsystem::UnregisterVisibilityVolume(ADroneVisibilityVolume* Volume)
+{
+	VisibilityVolumes.Remove(Volume);
+}
+
+bool UDronePerceptionSubsystem::IsHiddenByVisibilitySet(const FVector& From, const FVector& To) const
+{
+	for (const TWeakObjectPtr<ADroneVisibilityVolume>& Volume : VisibilityVolumes)
+	{
+		bool bVisible = true;
+		if (Volume.IsValid() && Volume->TestVisibility(From, To, bVisible))
+		{
+			return !bVisible;
+		}
+	}
+
+	// Not covered by a single volume, only a trace can tell
+	return false;
+}
+
+void UDronePerceptionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_DronePerceptionTraces);
+
+	// Drones whose answer is oldest go first, the others keep their last result for another frame
+	Requests.Sort([](const FSightRequest& A, const FSightRequest& B) { return A.LastTraceTime < B.LastTraceTime; });
+
+	const int32 NumTraces = MaxTracesPerFrame > 0 ? FMath::Min(MaxTracesPerFrame, Requests.Num()) : Requests.Num();
+	for (int32 Index = 0; Index < NumTraces; ++Index)
+	{
+		TraceRequest(Requests[Index]);
+	}
+
+	INC_DWORD_STAT_BY(STAT_PerceptionTraces, NumTraces);
+	INC_DWORD_STAT_BY(STAT_PerceptionDeferred, Requests.Num() - NumTraces);
+	CSV_CUSTOM_STAT(LevelUpJam, PerceptionDeferredTraces, Requests.Num() - NumTraces, ECsvCustomStatOp::Set);
+	Requests.Reset();
+
+	// Forget destroyed drones and players
+	for (auto PlayerIt = Blackboard.CreateIterator(); PlayerIt; ++PlayerIt)
+	{
+		if (!PlayerIt.Key().IsValid())
+		{
+			PlayerIt.RemoveCurrent();
+			continue;
+		}
+
+		for (auto DroneIt = PlayerIt.Value().Drones.CreateIterator(); DroneIt; ++DroneIt)
+		{
+			if (!DroneIt.Key().IsValid())
+			{
+				DroneIt.RemoveCurrent();
+			}
+		}
+	}
+}
+
+void UDronePerceptionSubsystem::TraceRequest(const FSightRequest& Request)
+{
+	const ADrone* Drone = Request.Drone.Get();
+	const ABoxCharacter* Player = Request.Player.Get();
+	FPlayerPerception* Perception = Blackboard.Find(Request.Player);
+	if (!Drone || !Player || !Perception)
+	{
+		return;
+	}
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(DroneSight), false, Drone);
+
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::LineTraces);
+	FHitResult HitResult;
+	const bool bHit = GetWorld()->LineTraceSingleByChannel(HitResult, Drone->GetActorLocation(), Player->GetActorLocation(), ECC_Visibility, QueryParams);
+
+	// Nothing in the way, or the first thing hit is the player
+	const bool bVisible = !bHit || HitResult.GetActor() == Player;
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	FPlayerPerception::FDroneSight& Sight = Perception->Drones.FindOrAdd(Request.Drone);
+	Sight.bVisible = bVisible;
+	Sight.TraceTime = Now;
+
+	if (bVisible)
+	{
+		Perception->LastKnownLocation = Player->GetActorLocation();
+		Perception->LastKnownVelocity = Player->GetVelocity();
+		Perception->LastSeenTime = Now;
+		Perception->LastSeenBy = Request.Drone;
+	}
+}
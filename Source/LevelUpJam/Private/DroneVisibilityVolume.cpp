@@ -0,0 +1,287 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DroneVisibilityVolume.h"
+#include "DronePerceptionSubsystem.h"
+#include "LevelUpJam.h"
+#include "Components/BoxComponent.h"
+#include "Engine/World.h"
+#include "Misc/ScopedSlowTask.h"
+
+namespace DroneVisibility
+{
+	constexpr uint32 Magic = 0x5356504C; // "LPVS"
+	// Version 2 dilates the visible set, version 1 bakes are not conservative
+	constexpr uint32 Version = 2;
+
+	// A cell row is one bit per cell, so the file is NumCells^2 / 8 bytes: 8 MB at the limit
+	constexpr int32 MaxCells = 8192;
+
+#if WITH_EDITOR
+	// Sets every bit of Row whose cell is next to, or is, a cell set in Source. Separable: one
+	// pass along each axis grows the set by the 3x3x3 block around each cell.
+	void DilateRow(const uint8* Source, uint8* Row, const FIntVector& Dims, TArray<uint8>& Scratch)
+	{
+		const int32 NumCells = Dims.X * Dims.Y * Dims.Z;
+		Scratch.SetNumUninitialized(NumCells * 2);
+		uint8* Cells = Scratch.GetData();
+		uint8* Grown = Cells + NumCells;
+
+		for (int32 Index = 0; Index < NumCells; ++Index)
+		{
+			Cells[Index] = (Source[Index >> 3] >> (Index & 7)) & 1;
+		}
+
+		const int32 Strides[] = { 1, Dims.X, Dims.X * Dims.Y };
+		const int32 Sizes[] = { Dims.X, Dims.Y, Dims.Z };
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			const int32 Stride = Strides[Axis];
+			for (int32 Index = 0; Index < NumCells; ++Index)
+			{
+				const int32 Coord = (Index / Stride) % Sizes[Axis];
+				Grown[Index] = Cells[Index]
+					| (Coord > 0 ? Cells[Index - Stride] : 0)
+					| (Coord < Sizes[Axis] - 1 ? Cells[Index + Stride] : 0);
+			}
+			Swap(Cells, Grown);
+		}
+
+		for (int32 Index = 0; Index < NumCells; ++Index)
+		{
+			Row[Index >> 3] |= Cells[Index] << (Index & 7);
+		}
+	}
+#endif
+}
+
+ADroneVisibilityVolume::ADroneVisibilityVolume()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	VolumeBounds = CreateDefaultSubobject<UBoxComponent>(TEXT("VolumeBounds"));
+	RootComponent = VolumeBounds;
+	VolumeBounds->SetBoxExtent(FVector(2000.0f, 2000.0f, 400.0f));
+	VolumeBounds->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
+void ADroneVisibilityVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (VisibilitySet.Open(GetVisibilityFilePath(), DroneVisibility::Magic, DroneVisibility::Version))
+	{
+		if (UDronePerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UDronePerceptionSubsystem>())
+		{
+			Perception->RegisterVisibilityVolume(this);
+		}
+	}
+}
+
+void ADroneVisibilityVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UDronePerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UDronePerceptionSubsystem>())
+	{
+		Perception->UnregisterVisibilityVolume(this);
+	}
+	VisibilitySet.Close();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+FString ADroneVisibilityVolume::GetVisibilityFilePath() const
+{
+	const FString Name = FileName.IsEmpty() ? FBakedGridFile::GetDefaultFileName(this) : FileName;
+	return FBakedGridFile::GetBakedDataDir() / Name + TEXT(".pvs");
+}
+
+bool ADroneVisibilityVolume::ContainsLocation(const FVector& Location) const
+{
+	FIntVector Cell;
+	return VisibilitySet.IsOpen() && VisibilitySet.WorldToCell(Location, Cell);
+}
+
+bool ADroneVisibilityVolume::TestVisibility(const FVector& From, const FVector& To, bool& bOutVisible) const
+{
+	FIntVector FromCell;
+	FIntVector ToCell;
+	if (!VisibilitySet.WorldToCell(From, FromCell) || !VisibilitySet.WorldToCell(To, ToCell))
+	{
+		return false;
+	}
+
+	const uint8* Row = VisibilitySet.GetCellData(FromCell);
+	const int32 Bit = VisibilitySet.CellToIndex(ToCell);
+	bOutVisible = (Row[Bit >> 3] >> (Bit & 7)) & 1;
+	return true;
+}
+
+void ADroneVisibilityVolume::BakeVisibility()
+{
+#if WITH_EDITOR
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	const FBox VolumeBox = VolumeBounds->Bounds.GetBox();
+
+	FBakedGridHeader Header;
+	Header.Magic = DroneVisibility::Magic;
+	Header.Version = DroneVisibility::Version;
+	Header.Origin = FVector3f(VolumeBox.Min);
+	Header.CellSize = CellSize;
+	Header.Dimensions = FIntVector(
+		FMath::Max(1, FMath::CeilToInt32(VolumeBox.GetSize().X / CellSize)),
+		FMath::Max(1, FMath::CeilToInt32(VolumeBox.GetSize().Y / CellSize)),
+		FMath::Max(1, FMath::CeilToInt32(VolumeBox.GetSize().Z / CellSize)));
+
+	const FIntVector Dims = Header.Dimensions;
+	const int32 NumCells = Dims.X * Dims.Y * Dims.Z;
+	if (NumCells > DroneVisibility::MaxCells)
+	{
+		UE_LOG(LogLevelUpJam, Error, TEXT("Visibility volume %s has %d cells, the limit is %d. Raise CellSize or split the volume."),
+			*GetName(), NumCells, DroneVisibility::MaxCells);
+		return;
+	}
+
+	const int32 RowBytes = FMath::DivideAndRoundUp(NumCells, 8);
+	Header.BytesPerCell = RowBytes;
+	Header.PayloadSize = static_cast<uint64>(NumCells) * RowBytes;
+
+	// Sample points per cell: the center, then the corners pulled slightly inside the cell
+	TArray<FVector> Offsets;
+	Offsets.Add(FVector::ZeroVector);
+	for (int32 Corner = 0; Corner < 8 && Offsets.Num() < SamplesPerCell; ++Corner)
+	{
+		Offsets.Add(FVector(Corner & 1 ? 1.0f : -1.0f, Corner & 2 ? 1.0f : -1.0f, Corner & 4 ? 1.0f : -1.0f) * CellSize * 0.45f);
+	}
+
+	TArray<FVector> Centers;
+	Centers.SetNumUninitialized(NumCells);
+	for (int32 Z = 0; Z < Dims.Z; ++Z)
+	{
+		for (int32 Y = 0; Y < Dims.Y; ++Y)
+		{
+			for (int32 X = 0; X < Dims.X; ++X)
+			{
+				Centers[(Z * Dims.Y + Y) * Dims.X + X] = FVector(Header.Origin) + (FVector(X, Y, Z) + FVector(0.5)) * CellSize;
+			}
+		}
+	}
+
+	// Only static geometry is baked in, moving things are left to the runtime trace
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(DroneVisibilityBake), false, this);
+	QueryParams.MobilityType = EQueryMobilityType::Static;
+
+	TArray<uint8> Payload;
+	Payload.SetNumZeroed(static_cast<int32>(Header.PayloadSize));
+	auto SetVisible = [&Payload, RowBytes](int32 From, int32 To)
+	{
+		Payload[From * RowBytes + (To >> 3)] |= 1 << (To & 7);
+	};
+
+	FScopedSlowTask SlowTask(NumCells, NSLOCTEXT("LevelUpJam", "BakeVisibility", "Baking drone visibility..."));
+	SlowTask.MakeDialog(true);
+
+	int32 NumVisiblePairs = 0;
+	for (int32 From = 0; From < NumCells && !SlowTask.ShouldCancel(); ++From)
+	{
+		SlowTask.EnterProgressFrame();
+		SetVisible(From, From);
+
+		// Pairs are symmetric, each one is traced once
+		for (int32 To = From + 1; To < NumCells; ++To)
+		{
+			bool bVisible = false;
+			for (int32 FromSample = 0; FromSample < Offsets.Num() && !bVisible; ++FromSample)
+			{
+				for (int32 ToSample = 0; ToSample < Offsets.Num() && !bVisible; ++ToSample)
+				{
+					bVisible = !World->LineTraceTestByChannel(Centers[From] + Offsets[FromSample], Centers[To] + Offsets[ToSample], SightChannel, QueryParams);
+				}
+			}
+
+			if (bVisible)
+			{
+				SetVisible(From, To);
+				SetVisible(To, From);
+				++NumVisiblePairs;
+			}
+		}
+	}
+
+	if (SlowTask.ShouldCancel())
+	{
+		return;
+	}
+
+	// The rays only sample a few points per cell, a player standing elsewhere in a cell can still
+	// be seen where every sample is blocked. Growing both ends of each visible pair by one cell
+	// keeps the set conservative: a bit stays clear only when no sample ray between any cell
+	// around one and any cell around the other got through. Rows are grown first, then the bits
+	// inside each row.
+	SlowTask.EnterProgressFrame(0.0f, NSLOCTEXT("LevelUpJam", "DilateVisibility", "Growing the visible set..."));
+
+	auto OrRow = [RowBytes](uint8* Row, const uint8* Source)
+	{
+		for (int32 Byte = 0; Byte < RowBytes; ++Byte)
+		{
+			Row[Byte] |= Source[Byte];
+		}
+	};
+
+	TArray<uint8> Grown;
+	Grown.SetNumUninitialized(Payload.Num());
+	const int32 Strides[] = { 1, Dims.X, Dims.X * Dims.Y };
+	const int32 Sizes[] = { Dims.X, Dims.Y, Dims.Z };
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const int32 Stride = Strides[Axis];
+		for (int32 Cell = 0; Cell < NumCells; ++Cell)
+		{
+			const int32 Coord = (Cell / Stride) % Sizes[Axis];
+			uint8* Row = &Grown[Cell * RowBytes];
+			FMemory::Memcpy(Row, &Payload[Cell * RowBytes], RowBytes);
+			if (Coord > 0)
+			{
+				OrRow(Row, &Payload[(Cell - Stride) * RowBytes]);
+			}
+			if (Coord < Sizes[Axis] - 1)
+			{
+				OrRow(Row, &Payload[(Cell + Stride) * RowBytes]);
+			}
+		}
+		Swap(Payload, Grown);
+	}
+
+	TArray<uint8> Scratch;
+	int64 NumSetBits = 0;
+	for (int32 Cell = 0; Cell < NumCells; ++Cell)
+	{
+		uint8* Row = &Payload[Cell * RowBytes];
+		FMemory::Memcpy(&Grown[Cell * RowBytes], Row, RowBytes);
+		FMemory::Memzero(Row, RowBytes);
+		DroneVisibility::DilateRow(&Grown[Cell * RowBytes], Row, Dims, Scratch);
+
+		for (int32 Byte = 0; Byte < RowBytes; ++Byte)
+		{
+			NumSetBits += FMath::CountBits(Row[Byte]);
+		}
+	}
+
+	const FString Path = GetVisibilityFilePath();
+	if (FBakedGridFile::Write(Path, Header, Payload))
+	{
+		const int64 NumPairs = static_cast<int64>(NumCells) * (NumCells - 1) / 2;
+		const int64 NumGrownPairs = (NumSetBits - NumCells) / 2;
+		UE_LOG(LogLevelUpJam, Display, TEXT("Baked drone visibility %s: %dx%dx%d cells, %.0f%% of cell pairs traced visible, %.0f%% after growing, %.1f KB"),
+			*Path, Dims.X, Dims.Y, Dims.Z, NumPairs > 0 ? 100.0 * NumVisiblePairs / NumPairs : 100.0,
+			NumPairs > 0 ? 100.0 * NumGrownPairs / NumPairs : 100.0, Payload.Num() / 1024.0f);
+	}
+	else
+	{
+		UE_LOG(LogLevelUpJam, Error, TEXT("Failed to write drone visibility %s"), *Path);
+	}
+#endif
+}
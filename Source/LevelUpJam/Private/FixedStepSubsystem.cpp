@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FixedStepSubsystem.h"
+#include "LevelUpJam.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fixed Step Simulation"), STAT_FixedStepSimulation, STATGROUP_LevelUpJam);
+
+void UFixedStepSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	bEnabled |= FParse::Param(CommandLine, TEXT("LUJFixedStep"));
+	FParse::Value(CommandLine, TEXT("LUJFixedStepHz="), StepRate);
+	FParse::Value(CommandLine, TEXT("LUJSeed="), RandomSeed);
+
+	StepSeconds = 1.0f / FMath::Max(StepRate, 1.0f);
+	RandomStream.Initialize(RandomSeed);
+
+	if (bEnabled)
+	{
+		UE_LOG(LogLevelUpJam, Log, TEXT("Fixed step simulation at %.1f Hz, seed %d."), 1.0f / StepSeconds, RandomSeed);
+	}
+}
+
+void UFixedStepSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_FixedStepSimulation);
+
+	Accumulator += DeltaTime;
+
+	int32 NumSteps = 0;
+	while (Accumulator >= StepSeconds && NumSteps < MaxStepsPerFrame)
+	{
+		OnFixedStep.Broadcast(StepSeconds);
+		Accumulator -= StepSeconds;
+		++NumSteps;
+		++StepCount;
+	}
+
+	if (NumSteps == MaxStepsPerFrame)
+	{
+		Accumulator = FMath::Min(Accumulator, StepSeconds);
+	}
+
+	OnPresent.Broadcast(FMath::Clamp(Accumulator / StepSeconds, 0.0f, 1.0f));
+}
+
+TStatId UFixedStepSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFixedStepSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HUDViewModelSubsystem.h"
+#include "BoxCharacter.h"
+#include "RespawnPoint.h"
+
+void UHUDViewModelSubsystem::SetPlayer(ABoxCharacter* Player)
+{
+	if (!Player || !Player->IsLocallyControlled())
+	{
+		return;
+	}
+
+	// Full health is what the character class starts with
+	ShownPlayer = Player;
+	MaxHealth = GetDefault<ABoxCharacter>(Player->GetClass())->GetHealth();
+	Health = -1;
+	SetHealth(Player, Player->GetHealth());
+
+	const ARespawnPoint* RespawnPoint = Player->GetRespawnPoint();
+	SetCheckpoint(Player, RespawnPoint ? RespawnPoint->RespawnID : NAME_None);
+}
+
+void UHUDViewModelSubsystem::SetHealth(const ABoxCharacter* Player, int32 NewHealth)
+{
+	if (!IsShownPlayer(Player) || NewHealth == Health)
+	{
+		return;
+	}
+
+	Health = NewHealth;
+	OnHealthChanged.Broadcast(Health, MaxHealth);
+}
+
+void UHUDViewModelSubsystem::SetCheckpoint(const ABoxCharacter* Player, FName RespawnID)
+{
+	if (!IsShownPlayer(Player) || RespawnID == Checkpoint)
+	{
+		return;
+	}
+
+	Checkpoint = RespawnID;
+	OnCheckpointChanged.Broadcast(Checkpoint);
+}
+
+void UHUDViewModelSubsystem::AddDrone(EDroneState State)
+{
+	NumChasing += State == EDroneState::Chasing;
+	NumCarrying += State == EDroneState::Carrying;
+	UpdateAlertLevel();
+}
+
+void UHUDViewModelSubsystem::RemoveDrone(EDroneState State)
+{
+	NumChasing -= State == EDroneState::Chasing;
+	NumCarrying -= State == EDroneState::Carrying;
+	UpdateAlertLevel();
+}
+
+void UHUDViewModelSubsystem::ChangeDroneState(EDroneState OldState, EDroneState NewState)
+{
+	if (OldState == NewState)
+	{
+		return;
+	}
+
+	NumChasing += (NewState == EDroneState::Chasing) - (OldState == EDroneState::Chasing);
+	NumCarrying += (NewState == EDroneState::Carrying) - (OldState == EDroneState::Carrying);
+	UpdateAlertLevel();
+}
+
+bool UHUDViewModelSubsystem::IsShownPlayer(const ABoxCharacter* Player) const
+{
+	return Player && ShownPlayer.Get() == Player;
+}
+
+void UHUDViewModelSubsystem::UpdateAlertLevel()
+{
+	const EHUDAlertLevel NewAlertLevel = NumCarrying > 0 ? EHUDAlertLevel::Captured
+		: NumChasing > 0 ? EHUDAlertLevel::Alert
+		: EHUDAlertLevel::Calm;
+
+	if (NewAlertLevel != AlertLevel)
+	{
+		AlertLevel = NewAlertLevel;
+		OnAlertLevelChanged.Broadcast(AlertLevel);
+	}
+}
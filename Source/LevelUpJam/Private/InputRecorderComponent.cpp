@@ -0,0 +1,357 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "InputRecorderComponent.h"
+#include "LevelUpJam.h"
+#include "InputMappingContext.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerInput.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+
+namespace InputRecording
+{
+	constexpr uint32 Magic = 0x494A554C; // "LUJI"
+	constexpr uint16 Version = 2;
+	constexpr int32 MaxKeys = 32;
+
+	// Writes or reads one raw key value, one float per axis of the key
+	void SerializeValue(FArchive& Ar, const FKey& Key, FVector& Value)
+	{
+		float Components[3] = { static_cast<float>(Value.X), static_cast<float>(Value.Y), static_cast<float>(Value.Z) };
+
+		const int32 NumAxes = Key.IsAxis3D() ? 3 : Key.IsAxis2D() ? 2 : 1;
+		for (int32 Index = 0; Index < NumAxes; ++Index)
+		{
+			Ar << Components[Index];
+		}
+
+		if (Ar.IsLoading())
+		{
+			Value = FVector(Components[0], Components[1], Components[2]);
+		}
+	}
+}
+
+UInputRecorderComponent::UInputRecorderComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UInputRecorderComponent::SetupBindings(const UInputMappingContext* MappingContext, TConstArrayView<const UInputAction*> InActions)
+{
+	// A running recording or replay keeps its keys
+	if (MappingContext && !IsRecording() && !IsReplaying())
+	{
+		Keys.Reset();
+		Values.Reset();
+		for (const FEnhancedActionKeyMapping& Mapping : MappingContext->GetMappings())
+		{
+			if (InActions.Contains(Mapping.Action.Get()) && !Keys.Contains(Mapping.Key) && Keys.Num() < InputRecording::MaxKeys)
+			{
+				Keys.Add(Mapping.Key);
+				Values.Add(FVector::ZeroVector);
+			}
+		}
+	}
+
+	// Possession can happen more than once, only the first one picks up the command line
+	if (bStartedFromCommandLine)
+	{
+		return;
+	}
+	bStartedFromCommandLine = true;
+
+	FString Name;
+	if (FParse::Value(FCommandLine::Get(), TEXT("RecordInput="), Name))
+	{
+		StartRecording(Name);
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("ReplayInput="), Name))
+	{
+		StartReplay(Name);
+	}
+}
+
+FString UInputRecorderComponent::GetRecordingPath(const FString& Name, const UWorld* World)
+{
+	if (FPaths::GetExtension(Name) == TEXT("lujinput"))
+	{
+		return Name;
+	}
+
+	const FString MapName = World ? UWorld::RemovePIEPrefix(World->GetMapName()) : FString();
+	return FPaths::ProjectSavedDir() / TEXT("InputRecordings") / FString::Printf(TEXT("%s_%s.lujinput"), *Name, *MapName);
+}
+
+bool UInputRecorderComponent::StartRecording(const FString& Name)
+{
+	const APawn* Pawn = Cast<APawn>(GetOwner());
+	const APlayerController* Controller = GetPlayerController();
+	if (!Controller || !Controller->PlayerInput || Keys.IsEmpty() || IsReplaying())
+	{
+		return false;
+	}
+
+	StopRecording();
+
+	const FString Path = GetRecordingPath(Name, GetWorld());
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Path), true);
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*Path));
+	if (!Writer)
+	{
+		UE_LOG(LogLevelUpJam, Error, TEXT("InputRecorder: could not open %s for writing."), *Path);
+		return false;
+	}
+
+	uint32 Magic = InputRecording::Magic;
+	uint16 Version = InputRecording::Version;
+	uint8 NumKeys = static_cast<uint8>(Keys.Num());
+	float FixedDeltaTime = FApp::UseFixedTimeStep() ? static_cast<float>(FApp::GetFixedDeltaTime()) : 0.0f;
+	FVector Location = Pawn->GetActorLocation();
+	FRotator Rotation = Pawn->GetActorRotation();
+	FRotator ControlRotation = Controller->GetControlRotation();
+
+	*Writer << Magic << Version << NumKeys;
+	for (const FKey& Key : Keys)
+	{
+		FName KeyName = Key.GetFName();
+		*Writer << KeyName;
+	}
+	*Writer << FixedDeltaTime << Location << Rotation << ControlRotation;
+
+	for (FVector& Value : Values)
+	{
+		Value = FVector::ZeroVector;
+	}
+	UnchangedFrames = 0;
+
+	RecordHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UInputRecorderComponent::RecordFrame);
+
+	UE_LOG(LogLevelUpJam, Display, TEXT("InputRecorder: recording to %s"), *Path);
+	return true;
+}
+
+void UInputRecorderComponent::StopRecording()
+{
+	if (!Writer)
+	{
+		return;
+	}
+
+	// An empty change mask ends the stream
+	uint32 EndMask = 0;
+	Writer->SerializeIntPacked(UnchangedFrames);
+	*Writer << EndMask;
+	Writer->Close();
+	Writer.Reset();
+
+	FWorldDelegates::OnWorldPostActorTick.Remove(RecordHandle);
+}
+
+bool UInputRecorderComponent::StartReplay(const FString& Name)
+{
+	APawn* Pawn = Cast<APawn>(GetOwner());
+	APlayerController* Controller = GetPlayerController();
+	if (!Controller || IsRecording())
+	{
+		return false;
+	}
+
+	StopReplay();
+
+	const FString Path = GetRecordingPath(Name, GetWorld());
+	if (!FFileHelper::LoadFileToArray(ReplayData, *Path))
+	{
+		UE_LOG(LogLevelUpJam, Error, TEXT("InputRecorder: could not read %s"), *Path);
+		return false;
+	}
+
+	Reader = MakeUnique<FMemoryReader>(ReplayData);
+
+	uint32 Magic = 0;
+	uint16 Version = 0;
+	uint8 NumKeys = 0;
+	*Reader << Magic << Version << NumKeys;
+	if (Magic != InputRecording::Magic || Version != InputRecording::Version || NumKeys > InputRecording::MaxKeys)
+	{
+		UE_LOG(LogLevelUpJam, Error, TEXT("InputRecorder: %s is not a recording for this pawn."), *Path);
+		Reader.Reset();
+		return false;
+	}
+
+	// The recording brings its own keys, the mappings may have changed since
+	Keys.Reset();
+	Values.Reset();
+	for (int32 Index = 0; Index < NumKeys; ++Index)
+	{
+		FName KeyName;
+		*Reader << KeyName;
+		Keys.Add(FKey(KeyName));
+		Values.Add(FVector::ZeroVector);
+	}
+
+	float FixedDeltaTime = 0.0f;
+	FVector Location;
+	FRotator Rotation;
+	FRotator ControlRotation;
+	*Reader << FixedDeltaTime << Location << Rotation << ControlRotation;
+
+	if (FixedDeltaTime > 0.0f && (!FApp::UseFixedTimeStep() || !FMath::IsNearlyEqual(FApp::GetFixedDeltaTime(), FixedDeltaTime)))
+	{
+		UE_LOG(LogLevelUpJam, Warning, TEXT("InputRecorder: recorded with -UseFixedTimeStep at %.1f FPS, replay will not be exact without it."), 1.0f / FixedDeltaTime);
+	}
+
+	// Start from the recorded pose
+	Pawn->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+	Controller->SetControlRotation(ControlRotation);
+
+	Reader->SerializeIntPacked(FramesUntilNextRecord);
+
+	ReplayHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &UInputRecorderComponent::ReplayFrame);
+
+	UE_LOG(LogLevelUpJam, Display, TEXT("InputRecorder: replaying %s"), *Path);
+	return true;
+}
+
+void UInputRecorderComponent::StopReplay()
+{
+	if (!Reader)
+	{
+		return;
+	}
+
+	Reader.Reset();
+	ReplayData.Empty();
+
+	FWorldDelegates::OnWorldPreActorTick.Remove(ReplayHandle);
+
+	// Let go of anything still held so the pawn does not keep running
+	if (APlayerController* Controller = GetPlayerController())
+	{
+		for (int32 Index = 0; Index < Keys.Num(); ++Index)
+		{
+			if (!Keys[Index].IsAnalog() && !Values[Index].IsZero())
+			{
+				Controller->InputKey(FInputKeyParams(Keys[Index], IE_Released, FVector::ZeroVector, Keys[Index].IsGamepadKey()));
+			}
+			Values[Index] = FVector::ZeroVector;
+		}
+	}
+}
+
+void UInputRecorderComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopRecording();
+	StopReplay();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+APlayerController* UInputRecorderComponent::GetPlayerController() const
+{
+	const APawn* Pawn = Cast<APawn>(GetOwner());
+	return Pawn ? Pawn->GetController<APlayerController>() : nullptr;
+}
+
+void UInputRecorderComponent::RecordFrame(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	// Sampled after the controller processed this frame's input, before modifiers ran
+	const APlayerController* Controller = GetPlayerController();
+	const UPlayerInput* PlayerInput = Controller ? Controller->PlayerInput.Get() : nullptr;
+	if (!PlayerInput)
+	{
+		StopRecording();
+		return;
+	}
+
+	uint32 ChangedMask = 0;
+	for (int32 Index = 0; Index < Keys.Num(); ++Index)
+	{
+		const FVector Value = PlayerInput->GetRawVectorForKey(Keys[Index]);
+		if (Value != Values[Index])
+		{
+			Values[Index] = Value;
+			ChangedMask |= 1u << Index;
+		}
+	}
+
+	if (ChangedMask == 0)
+	{
+		++UnchangedFrames;
+		return;
+	}
+
+	Writer->SerializeIntPacked(UnchangedFrames);
+	*Writer << ChangedMask;
+	for (int32 Index = 0; Index < Keys.Num(); ++Index)
+	{
+		if (ChangedMask & (1u << Index))
+		{
+			InputRecording::SerializeValue(*Writer, Keys[Index], Values[Index]);
+		}
+	}
+	UnchangedFrames = 0;
+}
+
+void UInputRecorderComponent::ReplayFrame(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	APlayerController* Controller = World == GetWorld() ? GetPlayerController() : nullptr;
+	if (!Controller)
+	{
+		return;
+	}
+
+	uint32 ChangedMask = 0;
+	if (FramesUntilNextRecord > 0)
+	{
+		--FramesUntilNextRecord;
+	}
+	else
+	{
+		*Reader << ChangedMask;
+		if (ChangedMask == 0 || Reader->IsError())
+		{
+			StopReplay();
+			UE_LOG(LogLevelUpJam, Display, TEXT("InputRecorder: replay finished."));
+			OnReplayFinished.Broadcast();
+			return;
+		}
+
+		for (int32 Index = 0; Index < Keys.Num(); ++Index)
+		{
+			if (ChangedMask & (1u << Index))
+			{
+				const bool bWasDown = !Values[Index].IsZero();
+				InputRecording::SerializeValue(*Reader, Keys[Index], Values[Index]);
+
+				// Buttons only send their press and release
+				const FKey& Key = Keys[Index];
+				if (!Key.IsAnalog() && bWasDown != !Values[Index].IsZero())
+				{
+					Controller->InputKey(FInputKeyParams(Key, bWasDown ? IE_Released : IE_Pressed, Values[Index], Key.IsGamepadKey()));
+				}
+			}
+		}
+		Reader->SerializeIntPacked(FramesUntilNextRecord);
+	}
+
+	// Axis samples only last one frame, held values are fed every frame
+	for (int32 Index = 0; Index < Keys.Num(); ++Index)
+	{
+		const FKey& Key = Keys[Index];
+		if (Key.IsAnalog() && !Values[Index].IsZero())
+		{
+			Controller->InputKey(FInputKeyParams(Key, Values[Index], DeltaTime, 1, Key.IsGamepadKey()));
+		}
+	}
+}
@@ -0,0 +1,273 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RoomStreamingSubsystem.h"
+#include "BoxCharacter.h"
+#include "LevelUpJam.h"
+#include "RespawnPoint.h"
+#include "Engine/Level.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/App.h"
+#include "Misc/PackageName.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rooms Loaded"), STAT_RoomsLoaded, STATGROUP_LevelUpJam);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rooms Streaming"), STAT_RoomsStreaming, STATGROUP_LevelUpJam);
+
+void URoomStreamingSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (!bEnabled || Rooms.IsEmpty())
+	{
+		return;
+	}
+
+	for (ULevelStreaming* Streaming : InWorld.GetStreamingLevels())
+	{
+		if (Streaming)
+		{
+			const FString ShortName = FPackageName::GetShortName(Streaming->GetWorldAssetPackageFName());
+			StreamingLevels.Add(FName(UWorld::RemovePIEPrefix(ShortName)), Streaming);
+		}
+	}
+
+	// Maps without the rooms (test maps, the benchmark) have nothing to stream
+	for (const FStreamingRoom& Room : Rooms)
+	{
+		if (!StreamingLevels.Contains(Room.Level))
+		{
+			UE_LOG(LogLevelUpJam, Verbose, TEXT("Rooms: '%s' is not a sublevel of %s."), *Room.Level.ToString(), *InWorld.GetName());
+		}
+	}
+
+	// The player spawns in the start room, load it before anything begins play. Its neighbours
+	// still stream in asynchronously.
+	const TWeakObjectPtr<ULevelStreaming>* StartStreaming = StreamingLevels.Find(StartRoom);
+	if (StartStreaming && StartStreaming->IsValid() && FindRoom(StartRoom))
+	{
+		ULevelStreaming* Streaming = StartStreaming->Get();
+		const double StartTime = FPlatformTime::Seconds();
+		Streaming->SetShouldBeLoaded(true);
+		Streaming->SetShouldBeVisible(true);
+		Streaming->bShouldBlockOnLoad = true;
+		InWorld.FlushLevelStreaming(EFlushLevelStreamingType::Full);
+
+		// Later reloads of the room happen while playing and must not block
+		Streaming->bShouldBlockOnLoad = false;
+		PeakUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+		UE_LOG(LogLevelUpJam, Log, TEXT("Rooms: %s loaded blocking in %.2fs"), *StartRoom.ToString(), FPlatformTime::Seconds() - StartTime);
+	}
+
+	UpdateStreaming();
+}
+
+void URoomStreamingSubsystem::Deinitialize()
+{
+	if (NumRoomLoads > 0)
+	{
+		LogReport();
+	}
+
+	StreamingLevels.Reset();
+	PlayerRooms.Reset();
+	LastPlayerRoom = NAME_None;
+	PendingLoads.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId URoomStreamingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URoomStreamingSubsystem, STATGROUP_Tickables);
+}
+
+void URoomStreamingSubsystem::OnRespawnPointChanged(ABoxCharacter* Player, ARespawnPoint* RespawnPoint)
+{
+	const FName Room = RespawnPoint ? GetRoomOf(RespawnPoint) : NAME_None;
+	if (Room.IsNone() || GetPlayerRoom(Player) == Room)
+	{
+		return;
+	}
+
+	PlayerRooms.Add(Player, Room);
+	LastPlayerRoom = Room;
+	OnPlayerRoomChanged.Broadcast(Player, Room);
+
+	if (bEnabled)
+	{
+		UpdateStreaming();
+	}
+}
+
+FName URoomStreamingSubsystem::GetRoomOf(const ARespawnPoint* RespawnPoint) const
+{
+	const ULevel* Level = RespawnPoint->GetLevel();
+	for (const TPair<FName, TWeakObjectPtr<ULevelStreaming>>& Pair : StreamingLevels)
+	{
+		if (Pair.Value.IsValid() && Pair.Value->GetLoadedLevel() == Level && FindRoom(Pair.Key))
+		{
+			return Pair.Key;
+		}
+	}
+
+	const FStreamingRoom* Room = Rooms.FindByPredicate([RespawnPoint](const FStreamingRoom& Candidate)
+	{
+		return Candidate.RespawnIDs.Contains(RespawnPoint->RespawnID);
+	});
+	return Room ? Room->Level : NAME_None;
+}
+
+FName URoomStreamingSubsystem::GetPlayerRoom(const ABoxCharacter* Player) const
+{
+	const FName* Room = PlayerRooms.Find(Player);
+	return Room ? *Room : NAME_None;
+}
+
+const FStreamingRoom* URoomStreamingSubsystem::FindRoom(FName Room) const
+{
+	return Rooms.FindByPredicate([Room](const FStreamingRoom& Candidate) { return Candidate.Level == Room; });
+}
+
+void URoomStreamingSubsystem::UpdateStreaming()
+{
+	for (auto It = PlayerRooms.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	TArray<FName, TInlineAllocator<8>> CurrentRooms;
+	PlayerRooms.GenerateValueArray(CurrentRooms);
+	if (CurrentRooms.IsEmpty())
+	{
+		const FName FallbackRoom = HasPlayerRoom() ? LastPlayerRoom : StartRoom;
+		if (!FallbackRoom.IsNone())
+		{
+			CurrentRooms.Add(FallbackRoom);
+		}
+	}
+
+	// Each player's room with one step of the graph either way, anything further is unloaded
+	TSet<FName> WantedRooms;
+	for (const FName Current : CurrentRooms)
+	{
+		if (const FStreamingRoom* Room = FindRoom(Current))
+		{
+			WantedRooms.Add(Current);
+			WantedRooms.Append(Room->NextRooms);
+			for (const FStreamingRoom& Previous : Rooms)
+			{
+				if (Previous.NextRooms.Contains(Current))
+				{
+					WantedRooms.Add(Previous.Level);
+				}
+			}
+		}
+	}
+
+	for (const FStreamingRoom& Room : Rooms)
+	{
+		const TWeakObjectPtr<ULevelStreaming>* Found = StreamingLevels.Find(Room.Level);
+		ULevelStreaming* Streaming = Found ? Found->Get() : nullptr;
+		if (!Streaming)
+		{
+			continue;
+		}
+
+		const bool bWanted = WantedRooms.Contains(Room.Level);
+		if (Streaming->ShouldBeLoaded() == bWanted)
+		{
+			continue;
+		}
+
+		// Loads and visibility changes are asynchronous, the level streams in over the next frames
+		Streaming->SetShouldBeLoaded(bWanted);
+		Streaming->SetShouldBeVisible(bWanted);
+
+		if (bWanted)
+		{
+			PendingLoads.Add(Room.Level, FPlatformTime::Seconds());
+		}
+		else
+		{
+			PendingLoads.Remove(Room.Level);
+		}
+		UE_LOG(LogLevelUpJam, Log, TEXT("Rooms: %s %s"), bWanted ? TEXT("loading") : TEXT("unloading"), *Room.Level.ToString());
+	}
+}
+
+void URoomStreamingSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (StreamingLevels.IsEmpty())
+	{
+		return;
+	}
+
+	// Hitches only count while something streams, in or out
+	const float FrameMs = static_cast<float>(FApp::GetDeltaTime() * 1000.0);
+	const bool bStreaming = !PendingLoads.IsEmpty() || GetWorld()->IsVisibilityRequestPending();
+
+	// Memory only grows while rooms stream in, no need to query the platform every frame
+	if (bStreaming)
+	{
+		PeakUsedPhysical = FMath::Max<uint64>(PeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+	}
+
+	if (bStreaming && FrameMs > HitchThresholdMs)
+	{
+		++NumHitches;
+		WorstHitchMs = FMath::Max(WorstHitchMs, FrameMs);
+		CSV_EVENT(LevelUpJam, TEXT("RoomHitch %.1fms"), FrameMs);
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	for (auto It = PendingLoads.CreateIterator(); It; ++It)
+	{
+		const TWeakObjectPtr<ULevelStreaming>* Found = StreamingLevels.Find(It.Key());
+		const ULevelStreaming* Streaming = Found ? Found->Get() : nullptr;
+		if (Streaming && !Streaming->IsLevelVisible())
+		{
+			continue;
+		}
+
+		const double LoadSeconds = Now - It.Value();
+		++NumRoomLoads;
+		TotalLoadSeconds += LoadSeconds;
+		MaxLoadSeconds = FMath::Max(MaxLoadSeconds, LoadSeconds);
+		UE_LOG(LogLevelUpJam, Log, TEXT("Rooms: %s visible after %.2fs"), *It.Key().ToString(), LoadSeconds);
+		It.RemoveCurrent();
+	}
+
+	int32 NumLoaded = 0;
+	for (const TPair<FName, TWeakObjectPtr<ULevelStreaming>>& Pair : StreamingLevels)
+	{
+		NumLoaded += Pair.Value.IsValid() && Pair.Value->IsLevelLoaded();
+	}
+
+	SET_DWORD_STAT(STAT_RoomsLoaded, NumLoaded);
+	SET_DWORD_STAT(STAT_RoomsStreaming, PendingLoads.Num());
+	CSV_CUSTOM_STAT(LevelUpJam, RoomsLoaded, NumLoaded, ECsvCustomStatOp::Set);
+}
+
+void URoomStreamingSubsystem::LogReport() const
+{
+	UE_LOG(LogLevelUpJam, Display, TEXT("Rooms: %d loads, %.2fs average, %.2fs max; %d hitches over %.0fms while streaming (worst %.1fms); peak used physical %.1f MB"),
+		NumRoomLoads, NumRoomLoads > 0 ? TotalLoadSeconds / NumRoomLoads : 0.0, MaxLoadSeconds,
+		NumHitches, HitchThresholdMs, WorstHitchMs, PeakUsedPhysical / (1024.0 * 1024.0));
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GRoomsReportCommand(
+	TEXT("LevelUpJam.Rooms.Report"),
+	TEXT("Log room loads, load hitches and peak memory since the map started."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (const URoomStreamingSubsystem* RoomStreaming = World ? World->GetSubsystem<URoomStreamingSubsystem>() : nullptr)
+		{
+			RoomStreaming->LogReport();
+		}
+	}));
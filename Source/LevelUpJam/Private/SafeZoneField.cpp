@@ -0,0 +1,249 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SafeZoneField.h"
+#include "SafeZoneSubsystem.h"
+#include "SafeZoneTrigger.h"
+#include "LevelUpJam.h"
+#include "Components/BoxComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+namespace SafeZoneField
+{
+	constexpr uint32 Magic = 0x465A5353; // "SSZF"
+	// Version 2 files hold the safe zone channel only and are re-baked
+	constexpr uint32 Version = 3;
+
+	// Two bytes per cell: distance to a safe zone and distance to cover, both in cells
+	constexpr int32 SafeZoneChannel = 0;
+	constexpr int32 CoverChannel = 1;
+	constexpr int32 BytesPerCell = 2;
+
+	constexpr uint8 MaxDistance = MAX_uint8;
+}
+
+ASafeZoneField::ASafeZoneField()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	FieldBounds = CreateDefaultSubobject<UBoxComponent>(TEXT("FieldBounds"));
+	RootComponent = FieldBounds;
+	FieldBounds->SetBoxExtent(FVector(2000.0f, 2000.0f, 500.0f));
+	FieldBounds->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
+void ASafeZoneField::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (Field.Open(GetFieldFilePath(), SafeZoneField::Magic, SafeZoneField::Version))
+	{
+		if (USafeZoneSubsystem* SafeZones = GetWorld()->GetSubsystem<USafeZoneSubsystem>())
+		{
+			SafeZones->RegisterField(this);
+		}
+	}
+}
+
+void ASafeZoneField::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USafeZoneSubsystem* SafeZones = GetWorld()->GetSubsystem<USafeZoneSubsystem>())
+	{
+		SafeZones->UnregisterField(this);
+	}
+	Field.Close();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+FString ASafeZoneField::GetFieldFilePath() const
+{
+	const FString Name = FileName.IsEmpty() ? FBakedGridFile::GetDefaultFileName(this) : FileName;
+	return FBakedGridFile::GetBakedDataDir() / Name + TEXT(".safezone");
+}
+
+bool ASafeZoneField::ContainsLocation(const FVector& Location) const
+{
+	FIntVector Cell;
+	return Field.IsOpen() && Field.WorldToCell(Location, Cell);
+}
+
+float ASafeZoneField::SampleChannel(const FVector& Location, int32 Channel) const
+{
+	FIntVector Cell;
+	if (!Field.WorldToCell(Location, Cell))
+	{
+		return -1.0f;
+	}
+
+	const uint8 Distance = Field.GetCellData(Cell)[Channel];
+	return Distance == SafeZoneField::MaxDistance ? -1.0f : Distance * Field.GetHeader().CellSize;
+}
+
+float ASafeZoneField::GetSafeZoneDistance(const FVector& Location) const
+{
+	return SampleChannel(Location, SafeZoneField::SafeZoneChannel);
+}
+
+float ASafeZoneField::GetCoverDistance(const FVector& Location) const
+{
+	return SampleChannel(Location, SafeZoneField::CoverChannel);
+}
+
+FVector ASafeZoneField::GetDirectionToSafeZone(const FVector& Location) const
+{
+	FIntVector Cell;
+	if (!Field.WorldToCell(Location, Cell))
+	{
+		return FVector::ZeroVector;
+	}
+
+	// Central differences over the neighbouring cells, treating cells outside the grid as unknown
+	auto Sample = [this, &Cell](int32 X, int32 Y, int32 Z) -> float
+	{
+		const uint8* Data = Field.GetCellData(Cell + FIntVector(X, Y, Z));
+		return Data ? Data[SafeZoneField::SafeZoneChannel] : SafeZoneField::MaxDistance;
+	};
+
+	const FVector Gradient(
+		Sample(1, 0, 0) - Sample(-1, 0, 0),
+		Sample(0, 1, 0) - Sample(0, -1, 0),
+		Sample(0, 0, 1) - Sample(0, 0, -1));
+
+	return (-Gradient).GetSafeNormal();
+}
+
+void ASafeZoneField::BakeField()
+{
+#if WITH_EDITOR
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	const FBox FieldBox = FieldBounds->Bounds.GetBox();
+
+	FBakedGridHeader Header;
+	Header.Magic = SafeZoneField::Magic;
+	Header.Version = SafeZoneField::Version;
+	Header.Origin = FVector3f(FieldBox.Min);
+	Header.CellSize = CellSize;
+	Header.Dimensions = FIntVector(
+		FMath::Max(1, FMath::CeilToInt32(FieldBox.GetSize().X / CellSize)),
+		FMath::Max(1, FMath::CeilToInt32(FieldBox.GetSize().Y / CellSize)),
+		FMath::Max(1, FMath::CeilToInt32(FieldBox.GetSize().Z / CellSize)));
+	Header.BytesPerCell = SafeZoneField::BytesPerCell;
+
+	const FIntVector Dims = Header.Dimensions;
+	const int32 NumCells = Dims.X * Dims.Y * Dims.Z;
+	Header.PayloadSize = static_cast<uint64>(NumCells) * SafeZoneField::BytesPerCell;
+
+	auto CellCenter = [&Header](int32 X, int32 Y, int32 Z)
+	{
+		return FVector(Header.Origin) + (FVector(X, Y, Z) + FVector(0.5)) * Header.CellSize;
+	};
+	auto CellIndex = [&Dims](int32 X, int32 Y, int32 Z)
+	{
+		return (Z * Dims.Y + Y) * Dims.X + X;
+	};
+
+	TArray<FBox> SafeZoneBoxes;
+	for (TActorIterator<ASafeZoneTrigger> It(World); It; ++It)
+	{
+		SafeZoneBoxes.Add(It->GetComponentsBoundingBox());
+	}
+
+	// Distance to the nearest safe zone is exact, measured from the cell center to each zone's bounds
+	TArray<uint8> SafeDistances;
+	SafeDistances.SetNumUninitialized(NumCells);
+
+	// Cover starts as a solid/empty mask and is turned into distances with a breadth-first sweep
+	TArray<uint8> CoverDistances;
+	CoverDistances.Init(SafeZoneField::MaxDistance, NumCells);
+	TArray<FIntVector> Frontier;
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SafeZoneFieldBake), false, this);
+	// Slightly smaller than the cell, so a floor that only touches the bottom of a cell is not cover
+	const FCollisionShape CellShape = FCollisionShape::MakeBox(FVector(CellSize * 0.4f));
+
+	for (int32 Z = 0; Z < Dims.Z; ++Z)
+	{
+		for (int32 Y = 0; Y < Dims.Y; ++Y)
+		{
+			for (int32 X = 0; X < Dims.X; ++X)
+			{
+				const FVector Center = CellCenter(X, Y, Z);
+				const int32 Index = CellIndex(X, Y, Z);
+
+				float BestDistSq = TNumericLimits<float>::Max();
+				for (const FBox& ZoneBox : SafeZoneBoxes)
+				{
+					BestDistSq = FMath::Min(BestDistSq, static_cast<float>(ZoneBox.ComputeSquaredDistanceToPoint(Center)));
+				}
+				SafeDistances[Index] = SafeZoneBoxes.IsEmpty()
+					? SafeZoneField::MaxDistance
+					: static_cast<uint8>(FMath::Min(FMath::RoundToInt32(FMath::Sqrt(BestDistSq) / CellSize), SafeZoneField::MaxDistance - 1));
+
+				if (World->OverlapBlockingTestByChannel(Center, FQuat::Identity, CoverChannel, CellShape, QueryParams))
+				{
+					CoverDistances[Index] = 0;
+					Frontier.Add(FIntVector(X, Y, Z));
+				}
+			}
+		}
+	}
+
+	// Cover only spreads sideways: the floor under a player blocks no line of sight
+	static const FIntVector Neighbours[] =
+	{
+		FIntVector(1, 0, 0), FIntVector(-1, 0, 0),
+		FIntVector(0, 1, 0), FIntVector(0, -1, 0)
+	};
+
+	for (int32 Head = 0; Head < Frontier.Num(); ++Head)
+	{
+		const FIntVector Cell = Frontier[Head];
+		const uint8 NextDistance = CoverDistances[CellIndex(Cell.X, Cell.Y, Cell.Z)] + 1;
+		if (NextDistance >= SafeZoneField::MaxDistance)
+		{
+			continue;
+		}
+
+		for (const FIntVector& Offset : Neighbours)
+		{
+			const FIntVector Next = Cell + Offset;
+			if (Next.X < 0 || Next.Y < 0 || Next.Z < 0 || Next.X >= Dims.X || Next.Y >= Dims.Y || Next.Z >= Dims.Z)
+			{
+				continue;
+			}
+
+			uint8& Distance = CoverDistances[CellIndex(Next.X, Next.Y, Next.Z)];
+			if (Distance == SafeZoneField::MaxDistance)
+			{
+				Distance = NextDistance;
+				Frontier.Add(Next);
+			}
+		}
+	}
+
+	TArray<uint8> Payload;
+	Payload.SetNumUninitialized(NumCells * SafeZoneField::BytesPerCell);
+	for (int32 Index = 0; Index < NumCells; ++Index)
+	{
+		Payload[Index * SafeZoneField::BytesPerCell + SafeZoneField::SafeZoneChannel] = SafeDistances[Index];
+		Payload[Index * SafeZoneField::BytesPerCell + SafeZoneField::CoverChannel] = CoverDistances[Index];
+	}
+
+	const FString Path = GetFieldFilePath();
+	if (FBakedGridFile::Write(Path, Header, Payload))
+	{
+		UE_LOG(LogLevelUpJam, Display, TEXT("Baked safe zone field %s: %dx%dx%d cells, %d safe zones, %.1f KB"),
+			*Path, Dims.X, Dims.Y, Dims.Z, SafeZoneBoxes.Num(), Payload.Num() / 1024.0f);
+	}
+	else
+	{
+		UE_LOG(LogLevelUpJam, Error, TEXT("Failed to write safe zone field %s"), *Path);
+	}
+#endif
+}
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SafeZoneSubsystem.h"
+#include "SafeZoneTrigger.h"
+#include "SafeZoneField.h"
+#include "BoxCharacter.h"
+
+void USafeZoneSubsystem::EnterZone(ASafeZoneTrigger* Zone, ABoxCharacter* Player)
+{
+	if (!Zone || !Player)
+	{
+		return;
+	}
+
+	int32& OverlapCount = ZoneOccupants.FindOrAdd(Zone).FindOrAdd(Player);
+	if (++OverlapCount > 1)
+	{
+		return;
+	}
+
+	int32& ZoneCount = PlayerZoneCounts.FindOrAdd(Player);
+	if (++ZoneCount == 1)
+	{
+		OnPlayerSafeStateChanged.Broadcast(Player, true);
+	}
+}
+
+void USafeZoneSubsystem::LeaveZone(ASafeZoneTrigger* Zone, ABoxCharacter* Player)
+{
+	if (!Zone || !Player)
+	{
+		return;
+	}
+
+	TMap<TWeakObjectPtr<ABoxCharacter>, int32>* Occupants = ZoneOccupants.Find(Zone);
+	int32* OverlapCount = Occupants ? Occupants->Find(Player) : nullptr;
+	if (!OverlapCount)
+	{
+		return;
+	}
+
+	if (--(*OverlapCount) > 0)
+	{
+		return;
+	}
+
+	Occupants->Remove(Player);
+
+	int32* ZoneCount = PlayerZoneCounts.Find(Player);
+	if (ZoneCount && --(*ZoneCount) <= 0)
+	{
+		PlayerZoneCounts.Remove(Player);
+		OnPlayerSafeStateChanged.Broadcast(Player, false);
+	}
+}
+
+void USafeZoneSubsystem::RemoveZone(ASafeZoneTrigger* Zone)
+{
+	TMap<TWeakObjectPtr<ABoxCharacter>, int32> Occupants;
+	if (!ZoneOccupants.RemoveAndCopyValue(Zone, Occupants))
+	{
+		return;
+	}
+
+	for (const TPair<TWeakObjectPtr<ABoxCharacter>, int32>& Occupant : Occupants)
+	{
+		int32* ZoneCount = PlayerZoneCounts.Find(Occupant.Key);
+		if (ZoneCount && --(*ZoneCount) <= 0)
+		{
+			PlayerZoneCounts.Remove(Occupant.Key);
+			if (ABoxCharacter* Player = Occupant.Key.Get())
+			{
+				OnPlayerSafeStateChanged.Broadcast(Player, false);
+			}
+		}
+	}
+}
+
+bool USafeZoneSubsystem::IsPlayerSafe(ABoxCharacter* Player) const
+{
+	const int32* ZoneCount = PlayerZoneCounts.Find(Player);
+	return ZoneCount && *ZoneCount > 0;
+}
+
+int32 USafeZoneSubsystem::GetZoneOccupancy(ASafeZoneTrigger* Zone) const
+{
+	const TMap<TWeakObjectPtr<ABoxCharacter>, int32>* Occupants = ZoneOccupants.Find(Zone);
+	return Occupants ? Occupants->Num() : 0;
+}
+
+void USafeZoneSubsystem::RegisterField(ASafeZoneField* Field)
+{
+	Fields.AddUnique(Field);
+}
+
+void USafeZoneSubsystem::UnregisterField(ASafeZoneField* Field)
+{
+	Fields.Remove(Field);
+}
+
+const ASafeZoneField* USafeZoneSubsystem::FindField(const FVector& Location) const
+{
+	for (const TWeakObjectPtr<ASafeZoneField>& Field : Fields)
+	{
+		if (Field.IsValid() && Field->ContainsLocation(Location))
+		{
+			return Field.Get();
+		}
+	}
+	return nullptr;
+}
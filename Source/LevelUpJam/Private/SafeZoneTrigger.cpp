@@ -1,6 +1,7 @@
 #include "SafeZoneTrigger.h"
-#include "Drone.h"
+#include "SafeZoneSubsystem.h"
 #include "BoxCharacter.h"
+#include "LevelUpJam.h"
 #include "Components/BoxComponent.h"
 
 ASafeZoneTrigger::ASafeZoneTrigger()
@@ -8,9 +9,7 @@ ASafeZoneTrigger::ASafeZoneTrigger()
 	PrimaryActorTick.bCanEverTick = false;
 	TriggerBox = CreateDefaultSubobject<UBoxComponent>(TEXT("TriggerBox"));
 	RootComponent = TriggerBox;
-	TriggerBox->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-	TriggerBox->SetCollisionResponseToAllChannels(ECR_Ignore);
-	TriggerBox->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
+	TriggerBox->SetCollisionProfileName(LevelUpJamCollision::PlayerTriggerProfile);
 }
 
 void ASafeZoneTrigger::BeginPlay()
@@ -20,24 +19,37 @@ void ASafeZoneTrigger::BeginPlay()
 	TriggerBox->OnComponentEndOverlap.AddDynamic(this, &ASafeZoneTrigger::OnBoxEndOverlap);
 }
 
+void ASafeZoneTrigger::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USafeZoneSubsystem* SafeZones = GetWorld()->GetSubsystem<USafeZoneSubsystem>())
+	{
+		SafeZones->RemoveZone(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
 void ASafeZoneTrigger::OnBoxBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
-	if (ADrone* Drone = DroneRef)
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::OverlapEvents);
+
+	if (ABoxCharacter* Player = Cast<ABoxCharacter>(OtherActor))
 	{
-		if (ABoxCharacter* Player = Cast<ABoxCharacter>(OtherActor))
+		if (USafeZoneSubsystem* SafeZones = GetWorld()->GetSubsystem<USafeZoneSubsystem>())
 		{
-			Drone->ForceEndChase();
+			SafeZones->EnterZone(this, Player);
 		}
 	}
 }
 
 void ASafeZoneTrigger::OnBoxEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
 {
-	if (ADrone* Drone = DroneRef)
+	LevelUpJamCounters::Increment(LevelUpJamCounters::ECounter::OverlapEvents);
+
+	if (ABoxCharacter* Player = Cast<ABoxCharacter>(OtherActor))
 	{
-		if (ABoxCharacter* Player = Cast<ABoxCharacter>(OtherActor))
+		if (USafeZoneSubsystem* SafeZones = GetWorld()->GetSubsystem<USafeZoneSubsystem>())
 		{
-			Drone->bSafeZoneActive = false;
+			SafeZones->LeaveZone(this, Player);
 		}
 	}
 }
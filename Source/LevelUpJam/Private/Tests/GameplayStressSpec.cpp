@@ -0,0 +1,219 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BoxCharacter.h"
+#include "DamageSubsystem.h"
+#include "Drone.h"
+#include "LevelUpJam.h"
+#include "Obstacles/LaunchObstacle.h"
+#include "Obstacles/MovingObstacle.h"
+#include "Obstacles/Obstacle.h"
+#include "Components/BoxComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/TargetPoint.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/UObjectGlobals.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GameplayStress
+{
+	constexpr float StepSeconds = 1.0f / 60.0f;
+	constexpr float SpawnSpacing = 300.0f;
+	constexpr int32 NumPerType = 1000;
+	constexpr int32 SimulatedSeconds = 10;
+
+	// Fast enough for the movement to settle well inside a one second auto loop phase
+	constexpr float MoveSpeed = 20.0f;
+}
+
+/**
+ * Headless correctness and cost checks for the obstacle and drone code, for verifying performance
+ * refactors on a build machine:
+ *
+ * UnrealEditor-Cmd LevelUpJam.uproject -ExecCmds="Automation RunTests LevelUpJam.Gameplay; Quit" -NullRHI -Unattended
+ */
+BEGIN_DEFINE_SPEC(FGameplayStressSpec, "LevelUpJam.Gameplay",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext | EAutomationTestFlags::EngineFilter)
+
+	UWorld* World = nullptr;
+
+	void CreateWorld();
+	void DestroyWorld();
+	void StepWorld(int32 NumSteps);
+
+END_DEFINE_SPEC(FGameplayStressSpec)
+
+void FGameplayStressSpec::CreateWorld()
+{
+	World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("GameplayStressWorld"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	const FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+}
+
+void FGameplayStressSpec::DestroyWorld()
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World = nullptr;
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+void FGameplayStressSpec::StepWorld(int32 NumSteps)
+{
+	for (int32 Step = 0; Step < NumSteps; ++Step)
+	{
+		World->Tick(LEVELTICK_All, GameplayStress::StepSeconds);
+		++GFrameCounter;
+		LevelUpJamCounters::Reset();
+	}
+}
+
+void FGameplayStressSpec::Define()
+{
+	BeforeEach([this]()
+	{
+		CreateWorld();
+	});
+
+	AfterEach([this]()
+	{
+		DestroyWorld();
+	});
+
+	Describe("Auto-looping obstacles", [this]()
+	{
+		It("should activate on schedule and settle on the matching endpoint", [this]()
+		{
+			TArray<AObstacle*> Obstacles;
+			TArray<AMovingObstacle*> MovingObstacles;
+			TMap<const AObstacle*, int32> Activations;
+
+			const UClass* ObstacleClasses[] = { AObstacle::StaticClass(), AMovingObstacle::StaticClass(), ALaunchObstacle::StaticClass() };
+			const int32 NumClasses = UE_ARRAY_COUNT(ObstacleClasses);
+			const int32 GridSize = FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(GameplayStress::NumPerType * NumClasses)));
+
+			for (const UClass* ObstacleClass : ObstacleClasses)
+			{
+				for (int32 Index = 0; Index < GameplayStress::NumPerType; ++Index)
+				{
+					const int32 Slot = Obstacles.Num();
+					const FTransform Transform(FVector(Slot % GridSize, Slot / GridSize, 0.0f) * GameplayStress::SpawnSpacing);
+
+					AObstacle* Obstacle = World->SpawnActorDeferred<AObstacle>(const_cast<UClass*>(ObstacleClass), Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+					Obstacle->SetupAutoLoop();
+					Obstacle->OnActivatedNative.AddLambda([&Activations](AObstacle* Activated)
+					{
+						++Activations.FindOrAdd(Activated);
+					});
+
+					if (AMovingObstacle* Moving = Cast<AMovingObstacle>(Obstacle))
+					{
+						Moving->MoveSpeed = GameplayStress::MoveSpeed;
+						MovingObstacles.Add(Moving);
+					}
+
+					Obstacle->FinishSpawning(Transform);
+					Obstacles.Add(Obstacle);
+				}
+			}
+
+			// Stop halfway through a phase so no loop event sits on the last frame
+			const float EndTime = GameplayStress::SimulatedSeconds + 0.5f;
+			const int32 NumSteps = FMath::CeilToInt32(EndTime / GameplayStress::StepSeconds);
+
+			const double StartTime = FPlatformTime::Seconds();
+			StepWorld(NumSteps);
+			const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+			// Auto-loop activates at 1s, deactivates at 2s, activates at 3s, ...
+			const int32 ExpectedActivations = FMath::FloorToInt32((EndTime + 1.0f) / 2.0f);
+			int32 NumWrongCount = 0;
+			for (const AObstacle* Obstacle : Obstacles)
+			{
+				if (Activations.FindRef(Obstacle) != ExpectedActivations)
+				{
+					++NumWrongCount;
+				}
+			}
+			TestEqual(TEXT("Obstacles with the wrong activation count"), NumWrongCount, 0);
+
+			// The last event was an activation for an odd number of whole seconds
+			const bool bExpectRaised = (GameplayStress::SimulatedSeconds % 2) == 1;
+			int32 NumMisplaced = 0;
+			for (const AMovingObstacle* Moving : MovingObstacles)
+			{
+				const FVector Expected = bExpectRaised ? Moving->StartLocation + Moving->MoveDirection * Moving->MoveAmount : Moving->StartLocation;
+				if (!Moving->GetCollider()->GetRelativeLocation().Equals(Expected, KINDA_SMALL_NUMBER))
+				{
+					++NumMisplaced;
+				}
+			}
+			TestEqual(TEXT("Moving obstacles off their endpoint"), NumMisplaced, 0);
+
+			AddInfo(FString::Printf(TEXT("%d obstacles, %.1f simulated s in %.1f ms, %.3f us per actor tick"),
+				Obstacles.Num(), EndTime, ElapsedMs, ElapsedMs * 1000.0 / (static_cast<double>(NumSteps) * Obstacles.Num())));
+		});
+	});
+
+	Describe("Drone", [this]()
+	{
+		It("should patrol, chase, carry, return and patrol again", [this]()
+		{
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+			// Patrol close to the start, drop the player far enough away that the drone loses them on the way back
+			TArray<ATargetPoint*> PatrolPoints;
+			PatrolPoints.Add(World->SpawnActor<ATargetPoint>(FVector(0.0f, 0.0f, 300.0f), FRotator::ZeroRotator, SpawnParams));
+			PatrolPoints.Add(World->SpawnActor<ATargetPoint>(FVector(0.0f, 200.0f, 300.0f), FRotator::ZeroRotator, SpawnParams));
+			ATargetPoint* DropOff = World->SpawnActor<ATargetPoint>(FVector(0.0f, 3000.0f, 300.0f), FRotator::ZeroRotator, SpawnParams);
+
+			ADrone* Drone = World->SpawnActor<ADrone>(FVector(0.0f, 0.0f, 300.0f), FRotator::ZeroRotator, SpawnParams);
+			Drone->SpawnDefaultController();
+			Drone->SetDropOffPoint(DropOff);
+			Drone->SetPatrolPoints(PatrolPoints);
+
+			ABoxCharacter* Player = World->SpawnActor<ABoxCharacter>(FVector(400.0f, 0.0f, 300.0f), FRotator::ZeroRotator, SpawnParams);
+			const int32 StartHealth = Player->GetHealth();
+
+			const TArray<EDroneState> ExpectedCycle =
+			{
+				EDroneState::Patrolling, EDroneState::Chasing, EDroneState::Carrying, EDroneState::Returning, EDroneState::Patrolling
+			};
+
+			TArray<EDroneState> Visited = { Drone->GetCurrentState() };
+			const int32 MaxSteps = FMath::CeilToInt32(30.0f / GameplayStress::StepSeconds);
+			for (int32 Step = 0; Step < MaxSteps && Visited.Num() < ExpectedCycle.Num(); ++Step)
+			{
+				StepWorld(1);
+				if (Drone->GetCurrentState() != Visited.Last())
+				{
+					Visited.Add(Drone->GetCurrentState());
+				}
+			}
+
+			TestEqual(TEXT("States visited"), Visited.Num(), ExpectedCycle.Num());
+			for (int32 Index = 0; Index < FMath::Min(Visited.Num(), ExpectedCycle.Num()); ++Index)
+			{
+				TestEqual(*FString::Printf(TEXT("State %d"), Index), UEnum::GetValueAsString(Visited[Index]), UEnum::GetValueAsString(ExpectedCycle[Index]));
+			}
+
+			// Exactly one grab, resolved through the damage buffer
+			const UDamageSubsystem* DamageSubsystem = World->GetSubsystem<UDamageSubsystem>();
+			if (TestNotNull(TEXT("Damage subsystem"), DamageSubsystem))
+			{
+				const int32 GrabDamage = FMath::RoundToInt32(DamageSubsystem->GetDamageRow(EDamageKind::DroneGrab).Amount
+					* (1.0f - Player->GetDamageResistance(EDamageKind::DroneGrab)));
+				TestEqual(TEXT("Player health after one grab"), Player->GetHealth(), FMath::Max(StartHealth - GrabDamage, 0));
+			}
+		});
+	});
+}
+
+#endif
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+
+class AActor;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// Fixed header at the start of every baked grid file. The payload follows directly after it.
+struct FBakedGridHeader
+{
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	FVector3f Origin = FVector3f::ZeroVector;
+	float CellSize = 0.0f;
+	FIntVector Dimensions = FIntVector::ZeroValue;
+	uint32 BytesPerCell = 0;
+	uint64 PayloadSize = 0;
+};
+
+/**
+ * A regular grid of fixed-size cells baked to disk and memory-mapped at runtime, so lookups
+ * are a pointer offset and only the pages that are actually touched get paged in.
+ * Files live in Content/BakedData, which is staged as loose (non-UFS) files so they stay mappable.
+ */
+class LEVELUPJAM_API FBakedGridFile
+{
+public:
+	FBakedGridFile();
+	~FBakedGridFile();
+
+	static FString GetBakedDataDir();
+
+	// File name for an actor's baked data when none is set: map and actor name, the same in the
+	// editor, PIE and cooked builds
+	static FString GetDefaultFileName(const AActor* Actor);
+
+	static bool Write(const FString& Path, const FBakedGridHeader& Header, TConstArrayView<uint8> Payload);
+
+	bool Open(const FString& Path, uint32 ExpectedMagic, uint32 ExpectedVersion);
+	void Close();
+
+	bool IsOpen() const { return Payload != nullptr; }
+	const FBakedGridHeader& GetHeader() const { return Header; }
+	const uint8* GetPayload() const { return Payload; }
+
+	// Cell containing a world location, false when outside the grid
+	bool WorldToCell(const FVector& Location, FIntVector& OutCell) const;
+	FVector CellToWorld(const FIntVector& Cell) const;
+	int32 CellToIndex(const FIntVector& Cell) const;
+	bool IsValidCell(const FIntVector& Cell) const;
+
+	// Bytes of one cell, nullptr when outside the grid or not open
+	const uint8* GetCellData(const FIntVector& Cell) const;
+
+private:
+	FBakedGridHeader Header;
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	const uint8* Payload = nullptr;
+};
@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "LevelUpJam.h"
+#include "BenchmarkSubsystem.generated.h"
+
+class ADrone;
+class AMovingObstacle;
+struct FObstacleEvent;
+
+// One step of the scripted input path the benchmark drives the player through
+USTRUCT()
+struct FBenchmarkInputStep
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Config)
+	float Duration = 1.0f;
+
+	// X = right, Y = forward, relative to the control rotation
+	UPROPERTY(Config)
+	FVector2D Move = FVector2D::ZeroVector;
+
+	// Degrees per second added to the control yaw
+	UPROPERTY(Config)
+	float YawRate = 0.0f;
+
+	UPROPERTY(Config)
+	bool bJump = false;
+};
+
+/**
+ * Headless gameplay benchmark. Started with -LUJBenchmark, it loads each configured map, spawns
+ * extra drones and moving obstacles, drives the player along a scripted input path, records a CSV
+ * profiler capture and writes a JSON report that can be checked against a stored baseline.
+ *
+ * UnrealEditor LevelUpJam.uproject -game -nullrhi -nosound -unattended -LUJBenchmark
+ *     [-BenchmarkMaps=L_BoxLife+L_Doors] [-BenchmarkSeconds=30] [-BenchmarkDrones=N] [-BenchmarkObstacles=N]
+ *     [-BenchmarkBaseline=<report.json>] [-BenchmarkTolerance=0.1] [-BenchmarkReplay]
+ *
+ * -BenchmarkReplay records a replay of each measured map, to weigh its size and recording cost.
+ * Maps that fail to load are skipped, marked LoadFailed in the report and fail the run.
+ */
+UCLASS(Config = Game)
+class LEVELUPJAM_API UBenchmarkSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	bool IsRunning() const { return bRunning; }
+
+protected:
+	// Long package names of the maps to run, in order
+	UPROPERTY(Config)
+	TArray<FString> Maps;
+
+	UPROPERTY(Config)
+	TArray<FBenchmarkInputStep> InputPath;
+
+	UPROPERTY(Config)
+	TSoftClassPtr<ADrone> DroneClass;
+
+	UPROPERTY(Config)
+	TSoftClassPtr<AMovingObstacle> ObstacleClass;
+
+	UPROPERTY(Config)
+	int32 NumDrones = 10;
+
+	UPROPERTY(Config)
+	int32 NumObstacles = 100;
+
+	// Radius around the player in which the extra actors are spawned
+	UPROPERTY(Config)
+	float SpawnRadius = 3000.0f;
+
+	UPROPERTY(Config)
+	float WarmupSeconds = 2.0f;
+
+	UPROPERTY(Config)
+	float MeasureSeconds = 30.0f;
+
+	// Allowed relative increase over the baseline before a metric counts as a regression
+	UPROPERTY(Config)
+	float RegressionTolerance = 0.1f;
+
+	UPROPERTY(Config)
+	int32 RandomSeed = 1337;
+
+private:
+	struct FMapResult
+	{
+		FString Map;
+		TArray<float> FrameMs;
+		double GameThreadMsSum = 0.0;
+		int64 CounterSums[static_cast<int32>(LevelUpJamCounters::ECounter::Num)] = {};
+		uint64 PeakUsedPhysical = 0;
+
+		// From opening the map to its world being loaded, and the memory in use then
+		double LoadSeconds = 0.0;
+		uint64 UsedPhysicalAfterLoad = 0;
+
+		// The map could not be opened and was skipped
+		bool bLoadFailed = false;
+	};
+
+	void OnPostLoadMap(UWorld* World);
+	void StartMap(UWorld* World);
+	void OnObstacleEvents(TConstArrayView<FObstacleEvent> Events);
+	void FinishMap();
+	void OpenMap(int32 MapIndex);
+	void OpenNextMap();
+	bool Tick(float DeltaTime);
+	void DriveInput(float DeltaTime);
+	void SpawnActors(UWorld* World);
+	void WriteReport();
+
+	TSharedRef<class FJsonObject> MakeMapJson(const FMapResult& Result) const;
+	static FString GetReplayName(const FString& Map);
+	bool CompareWithBaseline(const TArray<TSharedPtr<class FJsonValue>>& MapReports) const;
+
+	FString BaselinePath;
+	FString OutputDir;
+	TArray<FName> CounterStatNames;
+
+	TArray<FMapResult> Results;
+	int32 CurrentMapIndex = INDEX_NONE;
+	TWeakObjectPtr<UWorld> CurrentWorld;
+
+	bool bRunning = false;
+	bool bMeasuring = false;
+	bool bRecordReplay = false;
+	double OpenMapTime = -1.0;
+	float MapElapsed = 0.0f;
+	float InputElapsed = 0.0f;
+	int32 InputStep = 0;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+	FDelegateHandle PostLoadMapHandle;
+};
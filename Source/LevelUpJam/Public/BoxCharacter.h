@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "InputActionValue.h"
+#include "DamageTypes.h"
 #include "BoxCharacter.generated.h"
 
 // Forward declarations
@@ -13,6 +14,16 @@ class UInputAction;
 class UCameraComponent;
 class USpringArmComponent;
 class ARespawnPoint;
+class UInputRecorderComponent;
+
+// Custom movement modes of ABoxCharacter (MOVE_Custom sub-modes)
+UENUM(BlueprintType)
+enum class EBoxMovementMode : uint8
+{
+	None,
+	// Held by a drone: movement simulation is suspended and the character follows the carrier
+	Carried
+};
 
 UCLASS(BlueprintType, Blueprintable)
 class LEVELUPJAM_API ABoxCharacter : public ACharacter
@@ -34,6 +45,10 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera)
 	UCameraComponent* CameraComponent;
 
+	// Records or replays this character's input, see -RecordInput= / -ReplayInput=
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Input)
+	UInputRecorderComponent* InputRecorder;
+
 	// Enhanced Input
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input)
 	UInputMappingContext* DefaultMappingContext;
@@ -73,6 +88,13 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Health")
 	int32 Health = 100;
 
+	// Fraction of each damage kind that is ignored (0 = full damage, 1 = immune)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Health")
+	TMap<EDamageKind, float> DamageResistances;
+
+	// World time until which incoming damage is ignored
+	double InvulnerableUntil = 0.0;
+
 	// Called when health reaches zero
 	UFUNCTION(BlueprintNativeEvent, Category = "Health")
 	void OnDeath();
@@ -97,16 +119,44 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Health")
 	int32 GetHealth() const { return Health; }
 
-	// Called when the character takes damage
+	// Queues generic damage on the damage subsystem; it is applied at the end of the frame.
+	// Amounts of zero or less are ignored.
 	UFUNCTION(BlueprintCallable, Category = "Health")
 	virtual void ReceiveDamage(int32 DamageAmount);
 
+	// Applies the total damage resolved for this frame by the damage subsystem
+	virtual void ApplyResolvedDamage(int32 DamageAmount, double NewInvulnerableUntil);
+
+	UFUNCTION(BlueprintPure, Category = "Health")
+	bool IsDead() const { return Health <= 0; }
+
+	bool IsInvulnerable(double WorldTime) const { return WorldTime < InvulnerableUntil; }
+
+	float GetDamageResistance(EDamageKind Kind) const;
+
 	// Set the current respawn point
 	UFUNCTION(BlueprintCallable, Category = "Respawn")
-	void SetRespawnPoint(ARespawnPoint* NewRespawnPoint) { CurrentRespawnPoint = NewRespawnPoint; }
+	void SetRespawnPoint(ARespawnPoint* NewRespawnPoint);
 	// Get the current respawn point
 	UFUNCTION(BlueprintPure, Category = "Respawn")
 	ARespawnPoint* GetRespawnPoint() const { return CurrentRespawnPoint; }
 
 	virtual void NotifyActorBeginOverlap(AActor* OtherActor) override;
+	virtual void NotifyControllerChanged() override;
+
+	// Hands the character's transform to a carrier. CharacterMovement stops simulating and the
+	// character follows the socket as a plain attachment.
+	void BeginCarried(USceneComponent* Carrier, FName Socket = NAME_None);
+
+	// Places the character at the nearest free spot around DropLocation and restores the movement
+	// mode and velocity it had when picked up. False when no free spot was found.
+	bool EndCarried(const FVector& DropLocation);
+
+	UFUNCTION(BlueprintPure, Category = "Movement")
+	bool IsCarried() const;
+
+private:
+	TEnumAsByte<EMovementMode> PreCarryMovementMode = MOVE_Walking;
+	uint8 PreCarryCustomMode = 0;
+	FVector PreCarryVelocity = FVector::ZeroVector;
 };
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DamageTypes.h"
+#include "DamageSubsystem.generated.h"
+
+class UDataTable;
+
+/**
+ * Collects damage from every source (drones, launch obstacles, hazards) into a per-frame buffer
+ * and resolves it in one pass, so a character hit several times in one frame only takes one
+ * health change and at most one OnDeath.
+ */
+UCLASS(Config = Game)
+class LEVELUPJAM_API UDamageSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Queue damage to be applied at the end of the frame
+	UFUNCTION(BlueprintCallable, Category = "Damage")
+	void QueueDamage(ABoxCharacter* Target, EDamageKind Kind, AActor* Source = nullptr, int32 AmountOverride = -1);
+
+	// Applies everything in the buffer. Called from Tick.
+	void ResolvePendingDamage();
+
+	// Resolves a batch of hits, grouped by target. Public for headless stress runs, which bring
+	// their own events instead of touching the frame's buffer.
+	void ResolveDamage(TArray<FQueuedDamage>& Events);
+
+	// Damage values for a kind, from the DataTable or the built-in defaults
+	FDamageTableRow GetDamageRow(EDamageKind Kind) const;
+
+	int32 GetNumPendingDamage() const { return PendingDamage.Num(); }
+
+protected:
+	// Table of FDamageTableRow, set in DefaultGame.ini
+	UPROPERTY(Config)
+	TSoftObjectPtr<UDataTable> DamageTable;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UDataTable> LoadedDamageTable;
+
+	// Rows cached from the table, indexed by EDamageKind
+	TArray<FDamageTableRow> DamageRows;
+
+	TArray<FQueuedDamage> PendingDamage;
+};
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "DamageTypes.generated.h"
+
+class ABoxCharacter;
+
+UENUM(BlueprintType)
+enum class EDamageKind : uint8
+{
+	Generic			UMETA(DisplayName = "Generic"),
+	DroneGrab		UMETA(DisplayName = "Drone Grab"),
+	Launch			UMETA(DisplayName = "Launch"),
+	Hazard			UMETA(DisplayName = "Hazard")
+};
+
+// Row of the damage DataTable. Rows are named after the EDamageKind entry (e.g. "DroneGrab").
+USTRUCT(BlueprintType)
+struct FDamageTableRow : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
+	int32 Amount = 0;
+
+	// Seconds the target ignores any further damage after being hurt by this kind
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
+	float InvulnerabilityTime = 0.0f;
+};
+
+// A single hit waiting in the per-frame damage buffer
+struct FQueuedDamage
+{
+	TWeakObjectPtr<ABoxCharacter> Target;
+	TWeakObjectPtr<AActor> Source;
+	EDamageKind Kind = EDamageKind::Generic;
+
+	// Negative means "use the DataTable amount"
+	int32 AmountOverride = -1;
+};
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DormancySubsystem.generated.h"
+
+class IDormantActor;
+
+/**
+ * Puts obstacles and drones to sleep while every player is further than their dormancy
+ * distance, and wakes them when one comes back. The default distance is meant to match the
+ * World Partition loading range, so actors at the edge of the streamed area do not tick.
+ */
+UCLASS(Config = Game)
+class LEVELUPJAM_API UDormancySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// The actor must implement IDormantActor
+	void RegisterActor(AActor* Actor);
+	void UnregisterActor(AActor* Actor);
+
+	// Wakes every dormant actor and stops putting new ones to sleep
+	void SetEnabled(bool bEnabled);
+
+	UFUNCTION(BlueprintPure, Category = "Dormancy")
+	int32 GetNumAwake() const { return Entries.Num() - NumDormant; }
+
+	UFUNCTION(BlueprintPure, Category = "Dormancy")
+	int32 GetNumDormant() const { return NumDormant; }
+
+protected:
+	/** Dormancy distance for actors that do not give their own. */
+	UPROPERTY(Config)
+	float DefaultDormancyDistance = 6000.0f;
+
+	/** Actors wake at the dormancy distance and sleep again this much further, to avoid flickering. */
+	UPROPERTY(Config)
+	float Hysteresis = 500.0f;
+
+	/** Seconds between two distance checks. */
+	UPROPERTY(Config)
+	float CheckInterval = 0.5f;
+
+	UPROPERTY(Config)
+	bool bEnabled = true;
+
+private:
+	struct FEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		IDormantActor* Dormant = nullptr;
+		double DormantSince = -1.0;
+
+		bool IsDormant() const { return DormantSince >= 0.0; }
+	};
+
+	void UpdateDormancy();
+	void Wake(FEntry& Entry);
+
+	TArray<FEntry> Entries;
+	TArray<FVector> PlayerLocations;
+	float TimeSinceCheck = 0.0f;
+	int32 NumDormant = 0;
+};
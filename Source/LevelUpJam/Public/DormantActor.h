@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "DormantActor.generated.h"
+
+UINTERFACE(MinimalAPI)
+class UDormantActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Actor that UDormancySubsystem can put to sleep while no player is near. A dormant actor stops
+ * ticking and pauses its timers; when woken it is told how long it slept and catches up without
+ * replaying every frame.
+ */
+class LEVELUPJAM_API IDormantActor
+{
+	GENERATED_BODY()
+
+public:
+	// Distance to the nearest player beyond which the actor goes dormant, 0 for the subsystem default
+	virtual float GetDormancyDistance() const { return 0.0f; }
+
+	// Actors in the middle of something (a chase, a carry) can refuse to go dormant
+	virtual bool CanEnterDormancy() const { return true; }
+
+	virtual void EnterDormancy() = 0;
+	virtual void ExitDormancy(float DormantSeconds) = 0;
+};
@@ -8,6 +8,8 @@
 #include "Components/SphereComponent.h"
 #include "GameFramework/FloatingPawnMovement.h"
 #include "Engine/TargetPoint.h"
+#include "Engine/NetSerialization.h"
+#include "DormantActor.h"
 #include "Drone.generated.h"
 
 UENUM(BlueprintType)
@@ -19,8 +21,36 @@ enum class EDroneState : uint8
 	Returning		UMETA(DisplayName = "Returning")
 };
 
+// What replicates of a drone: a dead reckoning snapshot, resent only when extrapolating the last
+// one drifts more than ADrone::ReplicationTolerance from the drone or its state changes
+USTRUCT()
+struct FDroneReplicatedState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize10 Location;
+
+	UPROPERTY()
+	FVector_NetQuantize10 Velocity;
+
+	// FRotator::CompressAxisToShort
+	UPROPERTY()
+	uint16 Pitch = 0;
+
+	UPROPERTY()
+	uint16 Yaw = 0;
+
+	UPROPERTY()
+	EDroneState State = EDroneState::Patrolling;
+
+	// LevelUpJamReplay::GetStateTime of the snapshot
+	UPROPERTY()
+	float SnapshotTime = 0.0f;
+};
+
 UCLASS()
-class LEVELUPJAM_API ADrone : public APawn
+class LEVELUPJAM_API ADrone : public APawn, public IDormantActor
 {
 	GENERATED_BODY()
 
@@ -31,6 +61,7 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	// Components
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
@@ -71,6 +102,21 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Detection")
 	float LosePlayerTime = 2.0f;
 
+	// Target selection between the players inside the detection sphere
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Detection|Targeting")
+	float DistanceWeight = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Detection|Targeting")
+	float AlignmentWeight = 1.0f;
+
+	// Weight of how recently the squad saw the player, fading out over LosePlayerTime
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Detection|Targeting")
+	float RecentSightWeight = 1.0f;
+
+	// Score a candidate needs over the current target before the drone switches to it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Detection|Targeting")
+	float TargetSwitchMargin = 0.25f;
+
 	// Drop Off System
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DropOff")
 	ATargetPoint* DropOffPoint;
@@ -78,6 +124,38 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DropOff")
 	float DropOffHeight = 100.0f;
 
+	// Socket on the drone mesh the carried player hangs from; none keeps the offset at the grab
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DropOff")
+	FName CarrySocket;
+
+	// Avoidance
+	// Radius kept clear of other drones
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Avoidance")
+	float AvoidanceRadius = 120.0f;
+
+	// Share of each avoidance this drone takes while carrying a player, so the others make way for it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Avoidance")
+	float CarryingAvoidanceWeight = 0.25f;
+
+	// Safe Zone System
+	// Use the baked safe zone field to give up hopeless chases and cut players off
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SafeZone")
+	bool bUseSafeZoneField = true;
+
+	// Only try to cut the player off when they are this close to a safe zone
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SafeZone")
+	float InterceptRange = 1000.0f;
+
+	// Players closer than this to cover can duck out of sight before reaching the safe zone, so
+	// the drone stays on them instead of cutting them off
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SafeZone")
+	float CoverChaseDistance = 200.0f;
+
+	// Replication
+	// Distance the extrapolated replicated location may drift from the drone before a new snapshot is sent
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Replication")
+	float ReplicationTolerance = 25.0f;
+
 	// State Management
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "State")
 	EDroneState CurrentState;
@@ -96,6 +174,35 @@ private:
 	FTimerHandle LosePlayerTimer;
 	bool bIsWaitingAtPatrol;
 	bool bPlayerInSight;
+	FDelegateHandle SafeStateChangedHandle;
+
+	// Fixed step simulation (see UFixedStepSubsystem): the drone moves kinematically on the step
+	// clock and its visible transform is interpolated between the last two steps
+	bool bUseFixedStep = false;
+	float SimDeltaSeconds = 0.0f;
+	FVector SimLocation;
+	FVector PreviousSimLocation;
+	FRotator SimRotation;
+	FRotator PreviousSimRotation;
+	FDelegateHandle FixedStepHandle;
+	FDelegateHandle PresentHandle;
+
+	void SimulateDrone(float DeltaTime);
+	void FixedStep(float StepSeconds);
+	void PresentFixedStep(float Alpha);
+
+	// Replication, see FDroneReplicatedState. Copies without authority do not simulate and only
+	// present the extrapolated snapshot.
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedState)
+	FDroneReplicatedState ReplicatedState;
+
+	UFUNCTION()
+	void OnRep_ReplicatedState();
+
+	void UpdateReplicatedState(const FVector& Velocity);
+	void PresentReplicatedState(float DeltaTime);
+	FVector GetReplicatedLocation() const;
+	FRotator GetReplicatedRotation() const;
 
 	// Movement functions
 	void MoveToLocation(const FVector& Location, float Speed);
@@ -111,6 +218,21 @@ private:
 	void StartLosePlayerTimer();
 	void ClearLosePlayerTimer();
 
+	// Target selection. Candidates are the players in the detection sphere, the closest ones when
+	// there are more than fit.
+	static constexpr int32 MaxTargetCandidates = 4;
+	TArray<TWeakObjectPtr<class ABoxCharacter>, TFixedAllocator<MaxTargetCandidates>> TargetCandidates;
+
+	void AddTargetCandidate(class ABoxCharacter* Player);
+	void SelectTarget();
+	float ScoreTarget(const class ABoxCharacter* Player) const;
+
+	// Safe zones
+	bool IsPlayerInSafeZone(class ABoxCharacter* Player) const;
+	void OnPlayerSafeStateChanged(class ABoxCharacter* Player, bool bIsSafe);
+	bool ShouldGiveUpChase(class ABoxCharacter* Player) const;
+	FVector GetChaseTarget(class ABoxCharacter* Player) const;
+
 	// Player interaction
 	void GrabPlayer(class ABoxCharacter* Player);
 	void DropPlayer();
@@ -124,6 +246,8 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
@@ -154,6 +278,14 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Drone")
 	bool HasDetectedPlayer() const { return DetectedPlayer != nullptr; }
 
-	// Used by SafeZoneTrigger to know if player is in safe zone
-	bool bSafeZoneActive = false;
+	// Location on the simulation clock: the last fixed step's pose rather than the interpolated one
+	FVector GetSimulatedLocation() const { return bUseFixedStep ? SimLocation : GetActorLocation(); }
+
+	// IDormantActor. Only a patrolling drone goes dormant; its patrol is replayed analytically on wake.
+	virtual bool CanEnterDormancy() const override { return CurrentState == EDroneState::Patrolling; }
+	virtual void EnterDormancy() override;
+	virtual void ExitDormancy(float DormantSeconds) override;
+
+protected:
+	void CatchUpPatrol(float Seconds);
 };
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DroneAvoidanceSubsystem.generated.h"
+
+class ADrone;
+
+/**
+ * Reciprocal collision avoidance (ORCA) between drones, in the horizontal plane. Drones hand
+ * their preferred velocity to AdjustVelocity while they move and get back the velocity solved at
+ * the end of the previous frame. Neighbours come from a uniform grid rebuilt once per frame, and
+ * the agents are solved in parallel. With UFixedStepSubsystem enabled the solve runs at the start
+ * of every fixed step instead, on the velocities wanted in the step before, so the result does
+ * not depend on the frame rate.
+ */
+UCLASS(Config = Game)
+class LEVELUPJAM_API UDroneAvoidanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterDrone(ADrone* Drone, float Radius);
+	void UnregisterDrone(ADrone* Drone);
+
+	// Records the velocity the drone wants this frame and returns the one it should fly at.
+	// Weight is the drone's share of each avoidance; a drone with a lower weight keeps its course
+	// more and leaves more of the avoiding to the other.
+	FVector AdjustVelocity(const ADrone* Drone, const FVector& PreferredVelocity, float MaxSpeed, float Weight = 1.0f);
+
+	void SetEnabled(bool bInEnabled) { bEnabled = bInEnabled; }
+
+	UFUNCTION(BlueprintPure, Category = "Avoidance")
+	int32 GetNumAgents() const { return Agents.Num(); }
+
+protected:
+	/** Drones further apart than this are not considered neighbours. Also the grid cell size. */
+	UPROPERTY(Config)
+	float NeighbourDistance = 600.0f;
+
+	/** Closest neighbours taken into account per drone. */
+	UPROPERTY(Config)
+	int32 MaxNeighbours = 8;
+
+	/** Seconds ahead in which collisions with other drones are avoided. */
+	UPROPERTY(Config)
+	float TimeHorizon = 1.0f;
+
+	UPROPERTY(Config)
+	bool bEnabled = true;
+
+private:
+	struct FAgent
+	{
+		TWeakObjectPtr<ADrone> Drone;
+		float Radius = 0.0f;
+		float Weight = 1.0f;
+		float MaxSpeed = 0.0f;
+
+		// Set by AdjustVelocity during the frame, consumed by the solve. Drones that did not move
+		// this frame are solved as standing still.
+		FVector PreferredVelocity = FVector::ZeroVector;
+		FVector AppliedVelocity = FVector::ZeroVector;
+
+		// Result of the last solve, only used while it differs from the preferred velocity
+		FVector2D SolvedVelocity = FVector2D::ZeroVector;
+		bool bAvoiding = false;
+	};
+
+	// Snapshot the parallel solve reads from
+	struct FAgentState
+	{
+		FVector Location;
+		FVector2D Velocity;
+		FVector2D PreferredVelocity;
+		float Radius;
+		float Weight;
+		float MaxSpeed;
+	};
+
+	void Solve(float StepSeconds);
+	void BuildGrid();
+	FVector2D SolveAgent(int32 Index, float StepSeconds) const;
+
+	bool bUseFixedStep = false;
+	FDelegateHandle FixedStepHandle;
+
+	TArray<FAgent> Agents;
+	TMap<TWeakObjectPtr<const ADrone>, int32> AgentIndices;
+
+	// Per-frame scratch data
+	TArray<FAgentState> States;
+	TArray<FVector2D> NewVelocities;
+	TArray<TPair<FIntPoint, int32>> CellAgents;
+	TMap<FIntPoint, FIntPoint> CellRanges;
+};
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DronePerceptionSubsystem.generated.h"
+
+class ABoxCharacter;
+class ADrone;
+class ADroneVisibilityVolume;
+
+// What the squad knows about one player
+struct FPlayerPerception
+{
+	struct FDroneSight
+	{
+		bool bVisible = false;
+		double TraceTime = -1.0;
+	};
+
+	FVector LastKnownLocation = FVector::ZeroVector;
+	FVector LastKnownVelocity = FVector::ZeroVector;
+
+	// World time of the last confirmed sighting, below 0 if never seen
+	double LastSeenTime = -1.0;
+	TWeakObjectPtr<const ADrone> LastSeenBy;
+
+	// Result of each drone's last line of sight trace; the visible ones are the visible-by set
+	TMap<TWeakObjectPtr<const ADrone>, FDroneSight> Drones;
+};
+
+/**
+ * Shared perception blackboard for drones. Drones ask it whether they can see a player instead of
+ * tracing themselves: a fresh sighting by another drone is reused by every drone that has the
+ * player in its sight cone, and the remaining requests are traced at the end of the frame under a
+ * per-frame budget, oldest results first. Results are read back on the drone's next tick.
+ * Pairs that a baked ADroneVisibilityVolume rules out are answered without any trace.
+ */
+UCLASS(Config = Game)
+class LEVELUPJAM_API UDronePerceptionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Whether Drone sees Player, as far as the squad knows. Queues a trace when the drone needs
+	// its own answer. Call it for players already in the drone's sight cone.
+	bool QuerySight(const ADrone* Drone, const ABoxCharacter* Player);
+
+	const FPlayerPerception* FindPerception(const ABoxCharacter* Player) const { return Blackboard.Find(Player); }
+
+	// Baked visibility volumes register themselves once their data is mapped
+	void RegisterVisibilityVolume(ADroneVisibilityVolume* Volume);
+	void UnregisterVisibilityVolume(ADroneVisibilityVolume* Volume);
+
+protected:
+	/** Line of sight traces per frame across all drones, 0 for no limit. */
+	UPROPERTY(Config)
+	int32 MaxTracesPerFrame = 4;
+
+	/** A sighting by another drone is trusted for this long, 0 to always trace. */
+	UPROPERTY(Config)
+	float SharedSightMaxAge = 0.25f;
+
+	/** A drone trusting shared sightings still traces on its own once its last trace is this old. */
+	UPROPERTY(Config)
+	float OwnTraceMaxAge = 0.5f;
+
+private:
+	struct FSightRequest
+	{
+		TWeakObjectPtr<const ADrone> Drone;
+		TWeakObjectPtr<const ABoxCharacter> Player;
+		double LastTraceTime = -1.0;
+	};
+
+	void TraceRequest(const FSightRequest& Request);
+
+	// Whether a baked volume proves static geometry blocks every line between the locations
+	bool IsHiddenByVisibilitySet(const FVector& From, const FVector& To) const;
+
+	TArray<TWeakObjectPtr<ADroneVisibilityVolume>> VisibilityVolumes;
+
+	TMap<TWeakObjectPtr<const ABoxCharacter>, FPlayerPerception> Blackboard;
+	TArray<FSightRequest> Requests;
+};
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "BakedGridFile.h"
+#include "DroneVisibilityVolume.generated.h"
+
+class UBoxComponent;
+
+/**
+ * Offline-baked potential visibility set over a volume. The volume is split into cells and each
+ * cell stores one bit per cell of the volume: set when static geometry may leave a line of sight
+ * between the two. The traced set is grown by one cell at both ends of every visible pair, so a
+ * sight line the sample rays missed inside a cell is still covered by its neighbours. Drones skip
+ * their line of sight trace when the bit for their cell and the player's cell is clear.
+ *
+ * The file is memory-mapped when the actor begins play, so under World Partition each volume is
+ * paged in with the cell it is placed in. Use several volumes rather than one over a whole map:
+ * the data grows with the square of the cell count, NumCells^2 / 8 bytes. A volume is limited to
+ * 8192 cells, an 8 MB file; 1000 cells take 122 KB. Rebake after moving walls.
+ */
+UCLASS()
+class LEVELUPJAM_API ADroneVisibilityVolume : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ADroneVisibilityVolume();
+
+	// False when either location is outside the baked grid, otherwise OutVisible is the baked bit
+	bool TestVisibility(const FVector& From, const FVector& To, bool& bOutVisible) const;
+
+	bool ContainsLocation(const FVector& Location) const;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Flyable area covered by the set
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	UBoxComponent* VolumeBounds;
+
+	UPROPERTY(EditAnywhere, Category = "Visibility", meta = (ClampMin = "50.0"))
+	float CellSize = 400.0f;
+
+	// Rays between the corners of two cells tested before they count as hidden from each other.
+	// 1 only tests the centers, which is cheaper to bake but can hide players standing near walls.
+	UPROPERTY(EditAnywhere, Category = "Visibility", meta = (ClampMin = "1", ClampMax = "9"))
+	int32 SamplesPerCell = 9;
+
+	// Static geometry on this channel blocks sight
+	UPROPERTY(EditAnywhere, Category = "Visibility")
+	TEnumAsByte<ECollisionChannel> SightChannel = ECC_Visibility;
+
+	// Baked file name inside Content/BakedData. Defaults to the map and actor name.
+	UPROPERTY(EditAnywhere, Category = "Visibility")
+	FString FileName;
+
+	UFUNCTION(CallInEditor, Category = "Visibility")
+	void BakeVisibility();
+
+private:
+	FString GetVisibilityFilePath() const;
+
+	FBakedGridFile VisibilitySet;
+};
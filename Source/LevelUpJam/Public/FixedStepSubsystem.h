@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FixedStepSubsystem.generated.h"
+
+// Simulation step of StepSeconds, broadcast zero or more times per frame
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnFixedStep, float /*StepSeconds*/);
+
+// Once per frame after the steps, with how far the clock is between the last two steps (0..1)
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnFixedStepPresent, float /*Alpha*/);
+
+/**
+ * Optional fixed-timestep clock for gameplay that must not depend on the frame rate (drones,
+ * moving and launch obstacles). Frame time is accumulated and consumed in whole steps; actors
+ * simulate in OnFixedStep and only move their visible transform in OnPresent. Off by default,
+ * enabled with bEnabled in DefaultGame.ini or -LUJFixedStep on the command line.
+ */
+UCLASS(Config = Game)
+class LEVELUPJAM_API UFixedStepSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Decided once when the world starts, actors read it in BeginPlay
+	bool IsEnabled() const { return bEnabled; }
+
+	float GetStepSeconds() const { return StepSeconds; }
+	uint64 GetStepCount() const { return StepCount; }
+
+	// Seeded gameplay random stream. Only use it from fixed steps to stay deterministic.
+	FRandomStream& GetRandomStream() { return RandomStream; }
+	void SetSeed(int32 Seed) { RandomStream.Initialize(Seed); }
+
+	FOnFixedStep OnFixedStep;
+	FOnFixedStepPresent OnPresent;
+
+protected:
+	UPROPERTY(Config)
+	bool bEnabled = false;
+
+	/** Simulation rate in Hz, -LUJFixedStepHz= overrides it. */
+	UPROPERTY(Config)
+	float StepRate = 60.0f;
+
+	/** Steps run in one frame at most. Time beyond that is dropped to avoid a spiral of death. */
+	UPROPERTY(Config)
+	int32 MaxStepsPerFrame = 8;
+
+	/** Seed of the gameplay random stream, -LUJSeed= overrides it. */
+	UPROPERTY(Config)
+	int32 RandomSeed = 1337;
+
+private:
+	FRandomStream RandomStream;
+	float StepSeconds = 1.0f / 60.0f;
+	float Accumulator = 0.0f;
+	uint64 StepCount = 0;
+};
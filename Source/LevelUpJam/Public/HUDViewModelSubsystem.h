@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Drone.h"
+#include "HUDViewModelSubsystem.generated.h"
+
+class ABoxCharacter;
+
+// How much trouble the player is in, from what the drones are doing
+UENUM(BlueprintType)
+enum class EHUDAlertLevel : uint8
+{
+	Calm,
+	// At least one drone is chasing
+	Alert,
+	// At least one drone is carrying a player away
+	Captured
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnHUDHealthChanged, int32, Health, int32, MaxHealth);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnHUDCheckpointChanged, FName, RespawnID);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnHUDAlertLevelChanged, EHUDAlertLevel, AlertLevel);
+
+/**
+ * What the game HUD shows, pushed in by the gameplay code when it changes instead of polled by
+ * widget bindings every frame. Widgets read the current values once when they are created and
+ * then only react to the events, which fire when a value actually changes.
+ *
+ * Health and checkpoint follow the locally controlled player; the alert level is shared.
+ */
+UCLASS()
+class LEVELUPJAM_API UHUDViewModelSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// The local player the HUD follows, pushes all of their values
+	void SetPlayer(ABoxCharacter* Player);
+
+	void SetHealth(const ABoxCharacter* Player, int32 NewHealth);
+	void SetCheckpoint(const ABoxCharacter* Player, FName RespawnID);
+
+	// Drones report their state when they appear, change state and disappear
+	void AddDrone(EDroneState State);
+	void RemoveDrone(EDroneState State);
+	void ChangeDroneState(EDroneState OldState, EDroneState NewState);
+
+	UFUNCTION(BlueprintPure, Category = "HUD")
+	int32 GetHealth() const { return Health; }
+
+	UFUNCTION(BlueprintPure, Category = "HUD")
+	int32 GetMaxHealth() const { return MaxHealth; }
+
+	UFUNCTION(BlueprintPure, Category = "HUD")
+	FName GetCheckpoint() const { return Checkpoint; }
+
+	UFUNCTION(BlueprintPure, Category = "HUD")
+	EHUDAlertLevel GetAlertLevel() const { return AlertLevel; }
+
+	UPROPERTY(BlueprintAssignable, Category = "HUD")
+	FOnHUDHealthChanged OnHealthChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "HUD")
+	FOnHUDCheckpointChanged OnCheckpointChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "HUD")
+	FOnHUDAlertLevelChanged OnAlertLevelChanged;
+
+private:
+	bool IsShownPlayer(const ABoxCharacter* Player) const;
+	void UpdateAlertLevel();
+
+	TWeakObjectPtr<const ABoxCharacter> ShownPlayer;
+
+	int32 Health = 0;
+	int32 MaxHealth = 0;
+	FName Checkpoint;
+	EHUDAlertLevel AlertLevel = EHUDAlertLevel::Calm;
+
+	// Drones per EDroneState
+	int32 NumChasing = 0;
+	int32 NumCarrying = 0;
+};
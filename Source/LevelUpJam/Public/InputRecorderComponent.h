@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "InputCoreTypes.h"
+#include "InputRecorderComponent.generated.h"
+
+class UInputAction;
+class UInputMappingContext;
+
+/**
+ * Records the raw values of the keys mapped to the owner's Enhanced Input actions to a compact
+ * binary file, and plays such a file back by feeding the keys to the player controller. Replayed
+ * input goes through the same mappings, modifiers and triggers as live input, so the pawn's own
+ * SetupPlayerInputComponent bindings run exactly as in the recorded session.
+ *
+ * Recording is delta-encoded: a frame is only written when a key value changed, prefixed by
+ * the number of unchanged frames before it. Files go to Saved/InputRecordings/<Name>_<Map>.lujinput.
+ * Start from the command line with -RecordInput=<Name> or -ReplayInput=<Name>.
+ */
+UCLASS(ClassGroup = (LevelUpJam), meta = (BlueprintSpawnableComponent))
+class LEVELUPJAM_API UInputRecorderComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UInputRecorderComponent();
+
+	// Called by the owner once its actions are bound, with the context that maps keys to them.
+	// Starts a command line recording or replay.
+	void SetupBindings(const UInputMappingContext* MappingContext, TConstArrayView<const UInputAction*> InActions);
+
+	UFUNCTION(BlueprintCallable, Category = "InputRecorder")
+	bool StartRecording(const FString& Name);
+
+	UFUNCTION(BlueprintCallable, Category = "InputRecorder")
+	void StopRecording();
+
+	UFUNCTION(BlueprintCallable, Category = "InputRecorder")
+	bool StartReplay(const FString& Name);
+
+	UFUNCTION(BlueprintCallable, Category = "InputRecorder")
+	void StopReplay();
+
+	UFUNCTION(BlueprintPure, Category = "InputRecorder")
+	bool IsRecording() const { return Writer.IsValid(); }
+
+	UFUNCTION(BlueprintPure, Category = "InputRecorder")
+	bool IsReplaying() const { return Reader.IsValid(); }
+
+	static FString GetRecordingPath(const FString& Name, const UWorld* World);
+
+	FSimpleMulticastDelegate OnReplayFinished;
+
+protected:
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	// Recording samples after every actor ticked, replay feeds keys before any actor ticks. World
+	// delegates rather than tick prerequisites: the pawn already ticks after its controller.
+	void RecordFrame(UWorld* World, ELevelTick TickType, float DeltaTime);
+	void ReplayFrame(UWorld* World, ELevelTick TickType, float DeltaTime);
+
+	class APlayerController* GetPlayerController() const;
+
+	// Keys mapped to the recorded actions
+	TArray<FKey> Keys;
+
+	// Values of the previous recorded frame, or the values being replayed
+	TArray<FVector> Values;
+
+	FDelegateHandle RecordHandle;
+	FDelegateHandle ReplayHandle;
+
+	TUniquePtr<FArchive> Writer;
+	uint32 UnchangedFrames = 0;
+
+	TArray<uint8> ReplayData;
+	TUniquePtr<FArchive> Reader;
+	uint32 FramesUntilNextRecord = 0;
+
+	bool bStartedFromCommandLine = false;
+};
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RoomStreamingSubsystem.generated.h"
+
+class ABoxCharacter;
+class ARespawnPoint;
+class ULevelStreaming;
+
+// Fired when a player's respawn point moves them to another room
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnPlayerRoomChanged, ABoxCharacter* /*Player*/, FName /*Room*/);
+
+// One room of the level sequence, a streaming sublevel of the persistent level
+USTRUCT()
+struct FStreamingRoom
+{
+	GENERATED_BODY()
+
+	// Short package name of the sublevel, e.g. L_Room_001_JumpPads
+	UPROPERTY(Config)
+	FName Level;
+
+	// Respawn points of the persistent level that count as this room. Points placed in the
+	// sublevel itself are found without being listed.
+	UPROPERTY(Config)
+	TArray<FName> RespawnIDs;
+
+	// Rooms reachable from this one
+	UPROPERTY(Config)
+	TArray<FName> NextRooms;
+};
+
+/**
+ * Streams rooms along the player's progression instead of loading every sublevel up front. The
+ * room of each player's current respawn point, the rooms before it and the rooms after it are
+ * loaded asynchronously; every other room is unloaded. The start room is loaded blocking at begin
+ * play so the player never stands in an empty room. Room loads, hitches while streaming and
+ * peak memory are recorded over the run and logged with LevelUpJam.Rooms.Report.
+ *
+ * Rooms must use the Blueprint streaming method in the Levels window, always loaded sublevels
+ * are left alone.
+ */
+UCLASS(Config = Game)
+class LEVELUPJAM_API URoomStreamingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Called by the player when they reach a checkpoint
+	void OnRespawnPointChanged(ABoxCharacter* Player, ARespawnPoint* RespawnPoint);
+
+	// Room the respawn point belongs to, None outside the room graph
+	FName GetRoomOf(const ARespawnPoint* RespawnPoint) const;
+
+	UFUNCTION(BlueprintPure, Category = "Rooms")
+	FName GetPlayerRoom(const ABoxCharacter* Player) const;
+
+	// True once any player reached a checkpoint of the room graph
+	bool HasPlayerRoom() const { return !LastPlayerRoom.IsNone(); }
+
+	void LogReport() const;
+
+	FOnPlayerRoomChanged OnPlayerRoomChanged;
+
+protected:
+	UPROPERTY(Config)
+	TArray<FStreamingRoom> Rooms;
+
+	/** Room streamed in before any player reached a checkpoint. */
+	UPROPERTY(Config)
+	FName StartRoom;
+
+	/** Frames slower than this while rooms stream count as load hitches. */
+	UPROPERTY(Config)
+	float HitchThresholdMs = 50.0f;
+
+	UPROPERTY(Config)
+	bool bEnabled = true;
+
+private:
+	const FStreamingRoom* FindRoom(FName Room) const;
+	void UpdateStreaming();
+
+	TMap<FName, TWeakObjectPtr<ULevelStreaming>> StreamingLevels;
+	TMap<TWeakObjectPtr<ABoxCharacter>, FName> PlayerRooms;
+
+	// Streamed around while no living player has a room, e.g. between a death and the respawn
+	FName LastPlayerRoom;
+
+	// Rooms requested to load, with the time of the request
+	TMap<FName, double> PendingLoads;
+
+	// Measured over the whole run
+	int32 NumRoomLoads = 0;
+	double TotalLoadSeconds = 0.0;
+	double MaxLoadSeconds = 0.0;
+	int32 NumHitches = 0;
+	float WorstHitchMs = 0.0f;
+	uint64 PeakUsedPhysical = 0;
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "BakedGridFile.h"
+#include "SafeZoneField.generated.h"
+
+class UBoxComponent;
+
+/**
+ * Offline-baked hiding-spot field over a volume. Each cell stores two distances: to the nearest
+ * ASafeZoneTrigger and to the nearest occluding cover. Drones use them to tell where a player is
+ * heading and whether they are about to duck out of sight, without any runtime traces. Bake it
+ * from the Details panel after moving safe zones or level geometry.
+ */
+UCLASS()
+class LEVELUPJAM_API ASafeZoneField : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ASafeZoneField();
+
+	// Distance in cm from the location to the nearest safe zone, negative when unknown
+	float GetSafeZoneDistance(const FVector& Location) const;
+
+	// Distance in cm from the location to the nearest cover, negative when unknown
+	float GetCoverDistance(const FVector& Location) const;
+
+	// Unit direction in which the safe zone distance falls fastest, zero when unknown
+	FVector GetDirectionToSafeZone(const FVector& Location) const;
+
+	bool ContainsLocation(const FVector& Location) const;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Area covered by the field
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	UBoxComponent* FieldBounds;
+
+	UPROPERTY(EditAnywhere, Category = "SafeZoneField", meta = (ClampMin = "10.0"))
+	float CellSize = 100.0f;
+
+	// Geometry on this channel counts as cover
+	UPROPERTY(EditAnywhere, Category = "SafeZoneField")
+	TEnumAsByte<ECollisionChannel> CoverChannel = ECC_Visibility;
+
+	// Baked file name inside Content/BakedData. Defaults to the map and actor name.
+	UPROPERTY(EditAnywhere, Category = "SafeZoneField")
+	FString FileName;
+
+	UFUNCTION(CallInEditor, Category = "SafeZoneField")
+	void BakeField();
+
+private:
+	FString GetFieldFilePath() const;
+	float SampleChannel(const FVector& Location, int32 Channel) const;
+
+	FBakedGridFile Field;
+};
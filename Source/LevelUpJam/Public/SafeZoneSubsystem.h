@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SafeZoneSubsystem.generated.h"
+
+class ABoxCharacter;
+class ASafeZoneTrigger;
+class ASafeZoneField;
+
+// Fired once when a player enters their first safe zone (true) or leaves their last one (false)
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnPlayerSafeStateChanged, ABoxCharacter* /*Player*/, bool /*bIsSafe*/);
+
+/**
+ * Tracks which players are inside which safe zones. Zones report overlaps here, and anything
+ * that cares (drones) subscribes to OnPlayerSafeStateChanged instead of being wired to a zone.
+ */
+UCLASS()
+class LEVELUPJAM_API USafeZoneSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void EnterZone(ASafeZoneTrigger* Zone, ABoxCharacter* Player);
+	void LeaveZone(ASafeZoneTrigger* Zone, ABoxCharacter* Player);
+
+	// Drops every occupant of a zone, e.g. when the zone is destroyed or streamed out
+	void RemoveZone(ASafeZoneTrigger* Zone);
+
+	UFUNCTION(BlueprintPure, Category = "SafeZone")
+	bool IsPlayerSafe(ABoxCharacter* Player) const;
+
+	// Number of players currently inside the zone
+	UFUNCTION(BlueprintPure, Category = "SafeZone")
+	int32 GetZoneOccupancy(ASafeZoneTrigger* Zone) const;
+
+	FOnPlayerSafeStateChanged OnPlayerSafeStateChanged;
+
+	// Baked fields register themselves once their data is mapped
+	void RegisterField(ASafeZoneField* Field);
+	void UnregisterField(ASafeZoneField* Field);
+
+	// Baked field covering the location, if any
+	const ASafeZoneField* FindField(const FVector& Location) const;
+
+private:
+	TArray<TWeakObjectPtr<ASafeZoneField>> Fields;
+
+	// How many zones each player is inside
+	TMap<TWeakObjectPtr<ABoxCharacter>, int32> PlayerZoneCounts;
+
+	// How many overlaps each zone has per player. A player can be counted more than once when
+	// several of its components overlap the same zone.
+	TMap<TWeakObjectPtr<ASafeZoneTrigger>, TMap<TWeakObjectPtr<ABoxCharacter>, int32>> ZoneOccupants;
+};